@@ -0,0 +1,15 @@
+#pragma once
+
+// ホストのビルドで ESP-IDF のログを標準エラー出力に置き換える
+
+// C++
+#include <cstdio>
+
+#define ESP_LOGE(tag, format, ...) \
+  std::fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) \
+  std::fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) \
+  std::fprintf(stderr, "I %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) \
+  std::fprintf(stderr, "D %s: " format "\n", tag, ##__VA_ARGS__)
@@ -0,0 +1,21 @@
+#pragma once
+
+// ホストのビルドで ESP-IDF の ROM の CRC32 をソフトウェアで置き換える
+
+// C++
+#include <cstdint>
+
+/**
+ * 多項式 0xEDB88320 (反転) のCRC32 (入出力を反転する。ROMの関数と同じ値になる)
+ */
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf,
+                                 uint32_t len) {
+  crc = ~crc;
+  for (uint32_t i = 0; i < len; i++) {
+    crc ^= buf[i];
+    for (int k = 0; k < 8; k++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
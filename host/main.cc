@@ -0,0 +1,102 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Project
+#include "config.h"
+#include "maze/maze.h"
+#include "maze/simulator.h"
+
+namespace {
+/**
+ * @brief 引数のファイルとディレクトリ内の迷路ファイル (*.txt) を名前順に集める
+ */
+std::vector<std::filesystem::path> collect(int argc, char **argv) {
+  std::vector<std::filesystem::path> files;
+  for (int i = 1; i < argc; i++) {
+    const std::filesystem::path path(argv[i]);
+    if (!std::filesystem::is_directory(path)) {
+      files.push_back(path);
+      continue;
+    }
+    std::vector<std::filesystem::path> found;
+    for (const auto &entry : std::filesystem::directory_iterator(path)) {
+      if (entry.path().extension() == ".txt") {
+        found.push_back(entry.path());
+      }
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+  }
+  return files;
+}
+}  // namespace
+
+/**
+ * 迷路ファイル全てで探索と最短経路計算を模擬し、迷路ごとに1行のCSVを出力する
+ *   simulator [--goal X,Y] <迷路ファイル or ディレクトリ>...
+ * ゴールは指定がなければ config::Config::maze_goal とする。
+ * 探索の見積もり時間は探索レベルの拘束条件 (実機では config.json で設定) が
+ * 既定の0のままのため inf となる。
+ * 読み込めない迷路、ゴールに到達できない・スタートに戻れない迷路があれば
+ * 終了コードを1とする。
+ */
+int main(int argc, char **argv) {
+  config::Config conf;
+  if (argc >= 3 && std::string(argv[1]) == "--goal") {
+    if (std::sscanf(argv[2], "%d,%d", &conf.maze_goal[0],
+                    &conf.maze_goal[1]) != 2) {
+      std::fprintf(stderr, "Invalid goal: %s\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+    argv += 2;
+    argc -= 2;
+  }
+  const auto files = collect(argc, argv);
+  if (files.empty()) {
+    std::fprintf(stderr,
+                 "Usage: simulator [--goal X,Y] <maze file or directory>...\n");
+    return EXIT_FAILURE;
+  }
+  const maze::Position goal{static_cast<int8_t>(conf.maze_goal[0]),
+                            static_cast<int8_t>(conf.maze_goal[1])};
+
+  maze::Simulator simulator(conf);
+  int failed = 0;
+  std::printf(
+      "File,Size,Reached,Finished,Proven,GoalCells,Cells,Visited"
+      ",KnownLength,OptimalLength,GoalTime,SearchTime"
+      ",Fast0,Fast1,Fast2,Fast3,Fast4"
+      ",DecisionUs,MaxDecisionUs,PlanningUs\n");
+  for (const auto &file : files) {
+    auto truth = std::make_unique<maze::Maze>(conf.maze_size);
+    if (!truth->read_file(file.string())) {
+      std::fprintf(stderr, "Failed to read %s\n", file.c_str());
+      failed++;
+      continue;
+    }
+    const auto r = simulator.run(*truth, goal);
+    if (!r.reached || !r.finished || !std::isfinite(r.fast_time[0])) {
+      failed++;
+    }
+    // clang-format off
+    std::printf(
+      "%s,%dx%d,%d,%d,%d,%d,%d,%d"
+      ",%d,%d,%f,%f"
+      ",%f,%f,%f,%f,%f"
+      ",%f,%f,%f\n",
+      file.filename().c_str(), truth->width(), truth->height(), r.reached, r.finished, r.proven, r.goal_cells, r.cells, r.visited,
+      r.known_length, r.optimal_length, static_cast<double>(r.goal_time), static_cast<double>(r.search_time),
+      static_cast<double>(r.fast_time[0]), static_cast<double>(r.fast_time[1]), static_cast<double>(r.fast_time[2]), static_cast<double>(r.fast_time[3]), static_cast<double>(r.fast_time[4]),
+      static_cast<double>(r.decision_us), static_cast<double>(r.max_decision_us), static_cast<double>(r.planning_us)
+    );
+    // clang-format on
+  }
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// C++
+#include <cstdio>
+
+namespace test {
+/// 失敗した確認の数
+inline int failures = 0;
+
+/// 失敗した確認があれば1を返す (main の戻り値とする)
+inline int result() {
+  if (failures > 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", failures);
+  }
+  return failures > 0 ? 1 : 0;
+}
+}  // namespace test
+
+/**
+ * 条件が偽なら場所と式を出力して失敗を数える (中断はしない)
+ */
+#define CHECK(condition)                                          \
+  do {                                                            \
+    if (!(condition)) {                                           \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, \
+                   __LINE__, #condition);                         \
+      test::failures++;                                           \
+    }                                                             \
+  } while (0)
+
+/**
+ * 2つの値の差が tolerance 以内か確認する
+ */
+#define CHECK_NEAR(actual, expected, tolerance)                              \
+  do {                                                                       \
+    const double check_actual_ = static_cast<double>(actual);                \
+    const double check_expected_ = static_cast<double>(expected);            \
+    const double check_tolerance_ = static_cast<double>(tolerance);          \
+    if (!(check_actual_ - check_expected_ <= check_tolerance_ &&             \
+          check_expected_ - check_actual_ <= check_tolerance_)) {            \
+      std::fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n",   \
+                   __FILE__, __LINE__, #actual, #expected, check_actual_,    \
+                   check_expected_);                                         \
+      test::failures++;                                                      \
+    }                                                                        \
+  } while (0)
@@ -0,0 +1,122 @@
+// C++
+#include <cmath>
+#include <cstdio>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "data/scurve.h"
+#include "maze/compiler.h"
+#include "maze/maze.h"
+#include "run.h"
+
+namespace {
+using run::Mode;
+
+struct Case {
+  // スタート区画からの方角の列
+  std::string_view moves;
+  // 走行モードと距離 [mm] (旋回は slalom::Profile::travel)
+  std::vector<std::pair<Mode, float>> expected;
+};
+
+// 境界の速度が連続し、各直進が計画した速度まで加減速しきれるか
+void checkVelocities(const maze::Compiler::Route &route) {
+  CHECK(route.front().start_velocity < 1e-3f);
+  CHECK(route.back().end_velocity < 1e-3f);
+  for (std::size_t i = 0; i < route.size(); i++) {
+    const auto &param = route[i];
+    if (i > 0) {
+      CHECK_NEAR(route[i - 1].end_velocity, param.start_velocity, 1e-3);
+    }
+    if (param.mode == Mode::Straight || param.mode == Mode::Diagonal) {
+      data::SCurve curve;
+      curve.reset(param.length, param.start_velocity, param.end_velocity,
+                  param.max_velocity, param.max_acceleration,
+                  param.max_jerk);
+      CHECK_NEAR(curve.end_velocity(), param.end_velocity, 1.0);
+    } else {
+      CHECK(param.start_velocity > 0.0f);
+      CHECK(param.start_velocity <= param.max_velocity);
+    }
+  }
+}
+}  // namespace
+
+int main() {
+  // 45度の直交側は前後の直進を短縮する
+  const Case cases[] = {
+      {"NNNN", {{Mode::Straight, 360.0f}}},
+      {"NNEEE",
+       {{Mode::Straight, 135.0f},
+        {Mode::SlalomTurnRight90, 77.0f},
+        {Mode::Straight, 225.0f}}},
+      {"NNESS",
+       {{Mode::Straight, 135.0f},
+        {Mode::SlalomTurnRight180, 231.6f},
+        {Mode::Straight, 135.0f}}},
+      {"NENNN",
+       {{Mode::Straight, 11.25f},
+        {Mode::SlalomTurnRight45, 95.2f},
+        {Mode::SlalomTurnLeft45, 95.2f},
+        {Mode::Straight, 191.25f}}},
+      {"NENENENEN",
+       {{Mode::Straight, 11.25f},
+        {Mode::SlalomTurnRight45, 95.2f},
+        {Mode::Diagonal, 381.8f},
+        {Mode::SlalomTurnLeft45, 95.2f},
+        {Mode::Straight, 11.25f}}},
+      {"NENESEEE",
+       {{Mode::Straight, 11.25f},
+        {Mode::SlalomTurnRight45, 95.2f},
+        {Mode::Diagonal, 63.6f},
+        {Mode::SlalomTurnVRight90, 108.9f},
+        {Mode::SlalomTurnLeft45, 95.2f},
+        {Mode::Straight, 191.25f}}},
+      {"NNESES",
+       {{Mode::Straight, 135.0f},
+        {Mode::SlalomTurnRight135, 146.7f},
+        {Mode::Diagonal, 63.6f},
+        {Mode::SlalomTurnRight45, 95.2f},
+        {Mode::Straight, 11.25f}}},
+      {"NENESSS",
+       {{Mode::Straight, 11.25f},
+        {Mode::SlalomTurnRight45, 95.2f},
+        {Mode::Diagonal, 63.6f},
+        {Mode::SlalomTurnRight135, 146.7f},
+        {Mode::Straight, 225.0f}}},
+  };
+  const config::Config conf;
+  maze::Compiler compiler(conf);
+  for (const auto &c : cases) {
+    maze::Compiler::Path path{{0, 0}};
+    for (auto m : c.moves) {
+      const auto dir = m == 'N'   ? maze::Direction::North
+                       : m == 'E' ? maze::Direction::East
+                       : m == 'S' ? maze::Direction::South
+                                  : maze::Direction::West;
+      path.push_back(maze::neighbor(path.back(), dir));
+    }
+    const auto failures = test::failures;
+    CHECK(compiler.compile(path, run::Level::Fast0));
+    const auto &route = compiler.route();
+    CHECK(route.size() == c.expected.size());
+    if (route.size() != c.expected.size()) {
+      continue;
+    }
+    for (std::size_t i = 0; i < route.size(); i++) {
+      CHECK(route[i].mode == c.expected[i].first);
+      CHECK_NEAR(route[i].length, c.expected[i].second, 0.1);
+    }
+    checkVelocities(route);
+    CHECK(std::isfinite(compiler.time()) && compiler.time() > 0.0f);
+    if (test::failures != failures) {
+      std::fprintf(stderr, "Compiler: %.*s does not match\n",
+                   static_cast<int>(c.moves.size()), c.moves.data());
+    }
+  }
+  return test::result();
+}
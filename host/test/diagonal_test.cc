@@ -0,0 +1,77 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "run.h"
+
+namespace {
+// 制御周期 [s]
+constexpr float PERIOD = 0.001f;
+// 距離の許容誤差 [mm]
+constexpr float TOLERANCE = 0.05f;
+}  // namespace
+
+/**
+ * n単位の斜め直進1つと1単位の斜め直進のn回の連続を走り、
+ * 続く1単位の開始位置の誤差、制限、柱の横を通過した回数を確認する
+ */
+int main() {
+  const config::Config conf;
+  float max_error = 0.0f;
+  for (auto level : {run::Level::Fast0, run::Level::Fast2, run::Level::Fast4}) {
+    const auto turn =
+        run::parameter(conf, run::Mode::SlalomTurn, level).max_velocity;
+    for (int n = 1; n <= 8; n++) {
+      for (auto split : {false, true}) {
+        auto param = run::parameter(conf, run::Mode::Diagonal, level);
+        param.start_velocity = turn;
+        param.end_velocity = turn;
+        param.length = run::DIAGONAL_UNIT * static_cast<float>(split ? 1 : n);
+        const int segments = split ? 1 + n : 2;
+        // 速度は1周期保持されるものとして積分し、各周期の目標距離と比べる
+        run::Run run;
+        float distance = 0.0f;
+        float boundary = 0.0f;
+        float error = 0.0f;
+        int posts = 0;
+        for (int i = 0; i < segments; i++) {
+          // 最後は誤差を測るための1単位
+          const auto last = i + 1 == segments;
+          auto p = param;
+          p.length = last ? run::DIAGONAL_UNIT : param.length;
+          run.reset();
+          bool passing = false;
+          for (int tick = 0; tick < 10000; tick++) {
+            const auto &target = run.run(p);
+            error = distance - (boundary + target.length);
+            if (last) {
+              break;
+            }
+            CHECK(target.velocity <= p.max_velocity + 1e-3f);
+            CHECK(std::abs(target.acceleration) <= p.max_acceleration + 1e-3f);
+            if (run.passing_post() && !passing) {
+              posts++;
+            }
+            passing = run.passing_post();
+            distance += target.velocity * PERIOD;
+            if (run.finished()) {
+              break;
+            }
+          }
+          CHECK(last || run.finished());
+          boundary += p.length;
+        }
+        CHECK(std::abs(error) <= TOLERANCE);
+        CHECK(posts == n);
+        max_error = std::max(max_error, std::abs(error));
+      }
+    }
+  }
+  std::printf("Diagonal: distance error %.3f mm\n",
+              static_cast<double>(max_error));
+  return test::result();
+}
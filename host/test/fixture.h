@@ -0,0 +1,127 @@
+#pragma once
+
+// C++
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+// Project
+#include "maze/maze.h"
+#include "model.h"
+
+namespace test {
+/**
+ * @brief 乱数で壁を配置する (観測済みとなるのは配置した壁のみ)
+ */
+inline void randomMaze(maze::Maze &maze, uint32_t seed) {
+  std::minstd_rand rand(seed);
+  const auto cells = maze.width() * maze.height();
+  for (int i = 0; i < cells * 2; i++) {
+    maze::Position pos{static_cast<int8_t>(rand() % maze.width()),
+                       static_cast<int8_t>(rand() % maze.height())};
+    maze.set_wall(pos, static_cast<maze::Direction>(rand() % 4),
+                  rand() % 3 == 0);
+  }
+}
+
+/**
+ * @brief 乱数で壁を配置し、未観測の壁を全て壁なしとして観測済みにする
+ */
+inline void openMaze(maze::Maze &maze, uint32_t seed) {
+  randomMaze(maze, seed);
+  for (int8_t y = 0; y < maze.height(); y++) {
+    for (int8_t x = 0; x < maze.width(); x++) {
+      for (int d = 0; d < 4; d++) {
+        auto dir = static_cast<maze::Direction>(d);
+        if (!maze.is_observed({x, y}, dir)) {
+          maze.set_wall({x, y}, dir, false);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief fnをrepeat回実行し、1回あたりの平均の実行時間を返す [us]
+ */
+template <class F>
+double elapsed_us(F &&fn, int repeat = 1) {
+  const auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; i++) {
+    fn();
+  }
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  return elapsed.count() / repeat;
+}
+
+/**
+ * @brief 車体・モータの模擬 (左右のタイヤの半径を別に与える)
+ */
+struct Plant {
+  // 1制御周期の積分の分割数
+  static constexpr int SUBSTEPS = 10;
+  // 実機の定数
+  float weight = motion::Model::WEIGHT;
+  float inertia = motion::Model::INERTIA;
+  float resistance = motion::Model::MOTOR_RESISTANCE;
+  float friction = motion::Model::WHEEL_MECHANICAL_RESISTANCE[0];
+  // 左右のタイヤの半径・車輪間距離 [m]
+  float tire_left;
+  float tire_right;
+  float track;
+  // 車体の速度 [m/s]・角速度 [rad/s]
+  float velocity = 0.0f;
+  float angular_velocity = 0.0f;
+  // 車体の姿勢 [mm], [rad]
+  float x = 0.0f;
+  float y = 0.0f;
+  float angle = 0.0f;
+
+  // 実機の定数をモデルの値からずらす (質量・慣性モーメント・抵抗・摩擦)
+  void mismatch() {
+    weight *= 1.2f;
+    inertia *= 1.3f;
+    resistance *= 1.1f;
+    friction *= 1.5f;
+  }
+
+  // 左右のモータ電圧 [V] を1制御周期加える
+  void step(float left, float right) {
+    constexpr float DT = motion::Model::PERIOD / SUBSTEPS;
+    auto force = [&](float voltage, float wheel_velo, float tire) {
+      const auto motor_ang_velo =
+          wheel_velo / tire * motion::Model::WHEEL_GEAR_RATIO;
+      const auto current =
+          (voltage - motion::Model::BACK_EMF * motor_ang_velo) / resistance;
+      auto torque = motion::Model::MOTOR_TORQUE * current;
+      if (std::abs(wheel_velo) > 0.0f) {
+        torque -= std::copysign(friction, wheel_velo);
+      }
+      return torque * motion::Model::WHEEL_GEAR_RATIO / tire;
+    };
+    for (int k = 0; k < SUBSTEPS; k++) {
+      const auto force_left =
+          force(left, velocity - angular_velocity * track / 2.0f, tire_left);
+      const auto force_right = force(
+          right, velocity + angular_velocity * track / 2.0f, tire_right);
+      velocity += (force_left + force_right) / weight * DT;
+      angular_velocity +=
+          (force_right - force_left) * track / 2.0f / inertia * DT;
+      const auto mid = angle + angular_velocity * DT / 2.0f;
+      x += velocity * 1000.0f * DT * std::cos(mid);
+      y += velocity * 1000.0f * DT * std::sin(mid);
+      angle += angular_velocity * DT;
+    }
+  }
+
+  // 半径tireとしてエンコーダから求めた車体の速度 [mm/s]
+  [[nodiscard]] float measured_velocity(float tire) const {
+    const auto left = (velocity - angular_velocity * track / 2.0f) / tire_left;
+    const auto right =
+        (velocity + angular_velocity * track / 2.0f) / tire_right;
+    return (left + right) / 2.0f * tire * 1000.0f;
+  }
+};
+}  // namespace test
@@ -0,0 +1,127 @@
+// C++
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <queue>
+
+// Project
+#include "check.h"
+#include "fixture.h"
+#include "maze/flood.h"
+#include "maze/maze.h"
+
+namespace {
+using Distances =
+    std::array<std::array<maze::Flood::Distance, maze::MAX_SIZE>,
+               maze::MAX_SIZE>;
+
+// キューによる区画ごとの幅優先探索 (比較用)
+void queueFlood(const maze::Maze &maze, const maze::Flood::Rows &goals,
+                maze::Flood::Unknown unknown, Distances &distance) {
+  for (auto &row : distance) {
+    row.fill(maze::Flood::UNREACHABLE);
+  }
+  std::queue<maze::Position> queue;
+  for (int8_t y = 0; y < maze.height(); y++) {
+    for (int8_t x = 0; x < maze.width(); x++) {
+      if ((goals[y] >> x) & 0x01) {
+        distance[y][x] = 0;
+        queue.push({x, y});
+      }
+    }
+  }
+  while (!queue.empty()) {
+    auto pos = queue.front();
+    queue.pop();
+    for (int d = 0; d < 4; d++) {
+      auto dir = static_cast<maze::Direction>(d);
+      auto next = maze::neighbor(pos, dir);
+      const bool blocked =
+          maze.is_wall(pos, dir) || (unknown == maze::Flood::Unknown::Wall &&
+                                     !maze.is_observed(pos, dir));
+      if (blocked || !maze.contains(next) ||
+          distance[next.y][next.x] != maze::Flood::UNREACHABLE) {
+        continue;
+      }
+      distance[next.y][next.x] = distance[pos.y][pos.x] + 1;
+      queue.push(next);
+    }
+  }
+}
+
+// 乱数の迷路で歩数マップが幅優先探索と一致する
+void checkFlood(const std::array<int, 2> &size, uint32_t seed,
+                const maze::Flood::Rows &goals, maze::Flood::Unknown unknown) {
+  maze::Maze maze(size);
+  test::randomMaze(maze, seed);
+  auto flood = std::make_unique<maze::Flood>();
+  auto expected = std::make_unique<Distances>();
+  flood->update(maze, goals, unknown);
+  queueFlood(maze, goals, unknown, *expected);
+
+  int mismatch = 0;
+  maze::Flood::Distance farthest = 0;
+  for (int8_t y = 0; y < maze.height(); y++) {
+    for (int8_t x = 0; x < maze.width(); x++) {
+      const auto distance = flood->distance({x, y});
+      mismatch += distance != (*expected)[y][x] ? 1 : 0;
+      if (distance != maze::Flood::UNREACHABLE) {
+        farthest = std::max(farthest, distance);
+      }
+    }
+  }
+  CHECK(mismatch == 0);
+  // 最も遠い区画まで展開して止まる
+  CHECK(flood->steps() >= farthest);
+  CHECK(flood->steps() <= farthest + 1);
+}
+
+// 32x32の迷路で歩数マップの更新時間を幅優先探索と比べる
+void benchmark() {
+  constexpr int REPEAT = 200;
+  const auto goals =
+      maze::Flood::cells({{15, 15}, {16, 15}, {15, 16}, {16, 16}});
+  maze::Maze maze({32, 32});
+  test::randomMaze(maze, 1);
+  auto flood = std::make_unique<maze::Flood>();
+  auto expected = std::make_unique<Distances>();
+  const auto flood_us = test::elapsed_us(
+      [&] { flood->update(maze, goals, maze::Flood::Unknown::Open); }, REPEAT);
+  const auto queue_us = test::elapsed_us(
+      [&] { queueFlood(maze, goals, maze::Flood::Unknown::Open, *expected); },
+      REPEAT);
+  std::printf("Flood: 32x32 %.1f us (%d steps), Queue: %.1f us\n", flood_us,
+              flood->steps(), queue_us);
+  CHECK(flood_us < queue_us);
+}
+}  // namespace
+
+int main() {
+  using Unknown = maze::Flood::Unknown;
+  const auto goal = maze::Flood::cells({{7, 7}});
+  const auto area = maze::Flood::cells({{7, 7}, {8, 7}, {7, 8}, {8, 8}});
+  for (uint32_t seed = 1; seed <= 8; seed++) {
+    for (auto unknown : {Unknown::Open, Unknown::Wall}) {
+      checkFlood({16, 16}, seed, goal, unknown);
+      checkFlood({16, 16}, seed, area, unknown);
+      checkFlood({32, 32}, seed, area, unknown);
+      checkFlood({9, 5}, seed, maze::Flood::cells({{8, 4}}), unknown);
+    }
+  }
+
+  // 壁のない迷路ではマンハッタン距離となる
+  maze::Maze open({32, 32});
+  open.reset();
+  auto flood = std::make_unique<maze::Flood>();
+  flood->update(open, maze::Flood::cells({{31, 31}}), Unknown::Open);
+  CHECK(flood->distance({31, 0}) == 31);
+  CHECK(flood->distance({0, 31}) == 31);
+  CHECK(flood->distance({1, 1}) == 60);
+  // スタート区画は東側の壁を回り込む
+  CHECK(flood->distance({0, 0}) == 62);
+
+  benchmark();
+  return test::result();
+}
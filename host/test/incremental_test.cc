@@ -0,0 +1,137 @@
+// C++
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "fixture.h"
+#include "maze/flood.h"
+#include "maze/incremental.h"
+#include "maze/maze.h"
+#include "maze/simulator.h"
+
+namespace {
+/**
+ * 区画を蛇行順に訪れて壁を発見し、差分更新した歩数マップが
+ * 全体の再計算と常に一致するか確認する
+ * @return 全体の再計算に切り替えた回数
+ */
+int checkIncremental(const std::array<int, 2> &size, uint32_t seed,
+                     maze::Flood::Unknown unknown) {
+  const auto goals = maze::Flood::cells({{7, 7}, {8, 7}, {7, 8}, {8, 8}});
+  maze::Maze truth(size);
+  maze::Maze maze(size);
+  auto incremental = std::make_unique<maze::Incremental>(unknown);
+  auto flood = std::make_unique<maze::Flood>();
+  test::randomMaze(truth, seed);
+  incremental->reset(maze, goals);
+
+  int recomputed = 0;
+  for (int8_t y = 0; y < maze.height(); y++) {
+    for (int8_t x = 0; x < maze.width(); x++) {
+      const int8_t px = (y & 0x01) ? maze.width() - 1 - x : x;
+      const maze::Position pos{px, y};
+      for (int d = 0; d < 4; d++) {
+        auto dir = static_cast<maze::Direction>(d);
+        if (maze.set_wall(pos, dir, truth.is_wall(pos, dir))) {
+          incremental->invalidate(maze, pos, dir);
+        }
+      }
+      incremental->repair(maze);
+      CHECK(incremental->expansions() <= maze::Incremental::MAX_EXPANSIONS);
+      recomputed += incremental->recomputed() ? 1 : 0;
+
+      flood->update(maze, goals, unknown);
+      int mismatch = 0;
+      for (int8_t cy = 0; cy < maze.height(); cy++) {
+        for (int8_t cx = 0; cx < maze.width(); cx++) {
+          if (flood->distance({cx, cy}) != incremental->distance({cx, cy})) {
+            mismatch++;
+          }
+        }
+      }
+      CHECK(mismatch == 0);
+    }
+  }
+  return recomputed;
+}
+
+/**
+ * 迷路ファイルで探索を模擬し、壁を読んだ区画の順に差分更新したときの
+ * 1回の更新時間の分布を出力する
+ */
+void reportLatency(const char *name) {
+  const config::Config conf;
+  const maze::Position goal{static_cast<int8_t>(conf.maze_goal[0]),
+                            static_cast<int8_t>(conf.maze_goal[1])};
+  auto truth = std::make_unique<maze::Maze>(conf.maze_size);
+  CHECK(truth->read_file(std::string(MAZES_DIR) + "/" + name));
+  maze::Simulator simulator(conf);
+  const auto result = simulator.run(*truth, goal);
+  CHECK(result.finished);
+  CHECK(!result.trace.empty());
+
+  const auto goals = maze::Flood::cells({goal});
+  maze::Maze maze({truth->width(), truth->height()});
+  auto incremental = std::make_unique<maze::Incremental>();
+  auto flood = std::make_unique<maze::Flood>();
+  incremental->reset(maze, goals);
+  std::vector<double> latencies;
+  for (const auto &pos : result.trace) {
+    for (int d = 0; d < 4; d++) {
+      auto dir = static_cast<maze::Direction>(d);
+      if (maze.set_wall(pos, dir, truth->is_wall(pos, dir))) {
+        incremental->invalidate(maze, pos, dir);
+      }
+    }
+    latencies.push_back(test::elapsed_us([&] { incremental->repair(maze); }));
+    CHECK(incremental->expansions() <= maze::Incremental::MAX_EXPANSIONS);
+  }
+  const auto flood_us = test::elapsed_us(
+      [&] { flood->update(maze, goals, maze::Flood::Unknown::Open); }, 100);
+  int mismatch = 0;
+  for (int8_t y = 0; y < maze.height(); y++) {
+    for (int8_t x = 0; x < maze.width(); x++) {
+      if (flood->distance({x, y}) != incremental->distance({x, y})) {
+        mismatch++;
+      }
+    }
+  }
+  CHECK(mismatch == 0);
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](int p) {
+    return latencies[(latencies.size() - 1) * p / 100];
+  };
+  std::printf(
+      "Incremental: %s %d updates, p50 %.2f us, p99 %.2f us, max %.2f us "
+      "(full update %.2f us)\n",
+      name, static_cast<int>(latencies.size()), percentile(50),
+      percentile(99), latencies.back(), flood_us);
+}
+}  // namespace
+
+int main() {
+  using Unknown = maze::Flood::Unknown;
+  int recomputed = 0, repairs = 0;
+  for (uint32_t seed = 1; seed <= 8; seed++) {
+    for (auto unknown : {Unknown::Open, Unknown::Wall}) {
+      recomputed += checkIncremental({16, 16}, seed, unknown);
+      recomputed += checkIncremental({32, 32}, seed, unknown);
+      repairs += 16 * 16 + 32 * 32;
+    }
+  }
+  std::printf("Incremental: recomputed %d/%d\n", recomputed, repairs);
+
+  for (const auto *name : {"generated-16-loops.txt", "generated-16-tree.txt",
+                           "generated-32-loops.txt"}) {
+    reportLatency(name);
+  }
+  return test::result();
+}
@@ -0,0 +1,111 @@
+// C++
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Project
+#include "check.h"
+#include "fixture.h"
+#include "maze/journal.h"
+#include "maze/maze.h"
+
+namespace {
+using maze::Journal;
+using maze::Maze;
+using maze::Position;
+
+constexpr Position GOAL{7, 7};
+
+// 追記したレコードを全て読み戻せる
+void checkRoundTrip(const std::string &path) {
+  Maze source({16, 16});
+  test::randomMaze(source, 1);
+  {
+    Journal journal(path);
+    CHECK(journal.create(Maze({16, 16}), GOAL));
+    for (int8_t y = 0; y < 16; y++) {
+      for (int8_t x = 0; x < 16; x++) {
+        CHECK(journal.append(source, {x, y}));
+      }
+    }
+  }
+  Maze loaded({16, 16});
+  Journal journal(path);
+  CHECK(journal.load(loaded, GOAL));
+  CHECK(journal.records() > 0);
+  for (int8_t y = 0; y < 16; y++) {
+    for (int8_t x = 0; x < 16; x++) {
+      for (int d = 0; d < 4; d++) {
+        const auto dir = static_cast<maze::Direction>(d);
+        CHECK(loaded.is_observed({x, y}, dir) ==
+              source.is_observed({x, y}, dir));
+        CHECK(loaded.is_wall({x, y}, dir) == source.is_wall({x, y}, dir));
+      }
+    }
+  }
+  // 大きさ・ゴールが異なる記録は読み込まない
+  Maze other({32, 32});
+  CHECK(!Journal(path).load(other, GOAL));
+  CHECK(!Journal(path).load(loaded, {0, 1}));
+}
+
+// 途切れたレコード・壊れたレコードの手前で読み込みを打ち切る
+void checkCorruption(const std::string &path) {
+  Maze source({16, 16});
+  test::openMaze(source, 2);
+  {
+    Journal journal(path);
+    CHECK(journal.create(Maze({16, 16}), GOAL));
+    for (int8_t x = 0; x < 10; x++) {
+      CHECK(journal.append(source, {x, 3}));
+    }
+  }
+  const auto size = std::filesystem::file_size(path);
+  const auto record = sizeof(Journal::Record);
+  // ヘッダ + 作成時のスタート区画などのレコード + 追記した10レコード
+  const auto created = (size - 8) / record - 10;
+
+  // 最後のレコードの途中で途切れた
+  std::filesystem::resize_file(path, size - record / 2);
+  {
+    Maze loaded({16, 16});
+    Journal journal(path);
+    CHECK(journal.load(loaded, GOAL));
+    CHECK(journal.records() == static_cast<int>(created + 9));
+  }
+
+  // 5番目のレコードの1bitが化けた (8bitのXORでは2bitの反転を見逃す)
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    const auto offset = 8 + (created + 4) * record;
+    file.seekg(static_cast<std::streamoff>(offset));
+    char bytes[2];
+    file.read(bytes, 2);
+    bytes[0] ^= 0x01;
+    bytes[1] ^= 0x01;
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(bytes, 2);
+  }
+  {
+    Maze loaded({16, 16});
+    Journal journal(path);
+    CHECK(journal.load(loaded, GOAL));
+    CHECK(journal.records() == static_cast<int>(created + 4));
+  }
+}
+}  // namespace
+
+/**
+ * 壁情報の記録の読み書きと、途切れ・化けたレコードの検出を確認する
+ */
+int main() {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "journal_test.bin").string();
+  checkRoundTrip(path);
+  checkCorruption(path);
+  std::filesystem::remove(path);
+  std::filesystem::remove(path + ".tmp");
+  return test::result();
+}
@@ -0,0 +1,226 @@
+// C++
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// Project
+#include "check.h"
+#include "fixture.h"
+#include "maze/maze.h"
+
+namespace {
+using maze::Direction;
+using maze::Maze;
+using maze::Position;
+
+/**
+ * 区画ごとに四方の壁・観測済みを1byteで持つ表現 (比較用)
+ * 隣り合う区画で共有する壁を両側に書き込む。
+ */
+class CellMaze {
+ private:
+  // 下位4bit: 壁, 上位4bit: 観測済み (Directionの順)
+  std::array<std::array<uint8_t, maze::MAX_SIZE>, maze::MAX_SIZE> cells_{};
+  int width_;
+  int height_;
+
+ public:
+  CellMaze(int width, int height) : width_(width), height_(height) {}
+
+  [[nodiscard]] bool contains(Position pos) const {
+    return pos.x >= 0 && pos.y >= 0 && pos.x < width_ && pos.y < height_;
+  }
+  [[nodiscard]] bool is_wall(Position pos, Direction dir) const {
+    return (cells_[pos.y][pos.x] >> static_cast<int>(dir)) & 0x01;
+  }
+  bool set_wall(Position pos, Direction dir, bool exists) {
+    const auto wall = static_cast<uint8_t>(1 << static_cast<int>(dir));
+    const auto observed = static_cast<uint8_t>(wall << 4);
+    auto &cell = cells_[pos.y][pos.x];
+    const auto prev = cell;
+    cell = static_cast<uint8_t>((cell & ~wall) | (exists ? wall : 0) |
+                                observed);
+    const auto next = maze::neighbor(pos, dir);
+    if (contains(next)) {
+      const auto back = maze::rotate(dir, 2);
+      const auto back_wall = static_cast<uint8_t>(1 << static_cast<int>(back));
+      auto &other = cells_[next.y][next.x];
+      other = static_cast<uint8_t>((other & ~back_wall) |
+                                   (exists ? back_wall : 0) | (back_wall << 4));
+    }
+    return cell != prev;
+  }
+};
+
+// 外壁とスタート区画の壁のみの状態
+void checkReset() {
+  Maze maze({16, 16});
+  CHECK(maze.width() == 16);
+  CHECK(maze.height() == 16);
+  CHECK(maze.row_mask() == 0xffff);
+  for (int8_t i = 0; i < 16; i++) {
+    CHECK(maze.is_wall({0, i}, Direction::West));
+    CHECK(maze.is_wall({15, i}, Direction::East));
+    CHECK(maze.is_wall({i, 0}, Direction::South));
+    CHECK(maze.is_wall({i, 15}, Direction::North));
+    CHECK(maze.is_observed({15, i}, Direction::East));
+    CHECK(maze.is_observed({i, 15}, Direction::North));
+  }
+  CHECK(maze.is_wall({0, 0}, Direction::East));
+  CHECK(maze.is_wall({1, 0}, Direction::West));
+  CHECK(!maze.is_wall({0, 0}, Direction::North));
+  CHECK(!maze.is_observed({0, 0}, Direction::North));
+  CHECK(!maze.is_visited({0, 0}));
+  CHECK(!maze.contains({16, 0}));
+  CHECK(!maze.contains({0, -1}));
+
+  Maze full({40, 40});
+  CHECK(full.width() == maze::MAX_SIZE);
+  CHECK(full.row_mask() == ~Maze::Row{0});
+  CHECK(full.is_wall({31, 31}, Direction::East));
+  CHECK(full.is_wall({31, 31}, Direction::North));
+}
+
+// 隣り合う区画で壁を共有し、変化したときのみ true を返す
+void checkSetWall() {
+  Maze maze({16, 16});
+  CHECK(maze.set_wall({3, 4}, Direction::North, true));
+  CHECK(maze.is_wall({3, 5}, Direction::South));
+  CHECK(maze.is_observed({3, 5}, Direction::South));
+  CHECK(!maze.set_wall({3, 5}, Direction::South, true));
+  CHECK(maze.set_wall({3, 5}, Direction::South, false));
+  CHECK(!maze.is_wall({3, 4}, Direction::North));
+  CHECK(maze.is_observed({3, 4}, Direction::North));
+
+  // 未観測の壁なしを観測したときも変化とする
+  CHECK(maze.set_wall({5, 5}, Direction::West, false));
+  CHECK(!maze.set_wall({4, 5}, Direction::East, false));
+
+  // 外壁は変更しない
+  CHECK(!maze.set_wall({0, 3}, Direction::West, false));
+  CHECK(!maze.set_wall({15, 3}, Direction::East, false));
+  CHECK(maze.is_wall({15, 3}, Direction::East));
+
+  for (auto dir : {Direction::North, Direction::East, Direction::South,
+                   Direction::West}) {
+    maze.set_wall({8, 8}, dir, false);
+  }
+  CHECK(maze.is_visited({8, 8}));
+
+  // 乱数の迷路でも両側から見た壁が一致する
+  Maze random({32, 32});
+  test::randomMaze(random, 1);
+  for (int8_t y = 0; y < random.height(); y++) {
+    for (int8_t x = 0; x < random.width(); x++) {
+      for (int d = 0; d < 4; d++) {
+        const auto dir = static_cast<Direction>(d);
+        const auto next = maze::neighbor({x, y}, dir);
+        if (!random.contains(next)) {
+          CHECK(random.is_wall({x, y}, dir));
+          continue;
+        }
+        const auto back = maze::rotate(dir, 2);
+        CHECK(random.is_wall({x, y}, dir) == random.is_wall(next, back));
+        CHECK(random.is_observed({x, y}, dir) ==
+              random.is_observed(next, back));
+      }
+    }
+  }
+}
+
+// テキストの迷路を読み込み、全ての壁を観測済みとする
+void checkReadFile() {
+  const auto path =
+      std::filesystem::temp_directory_path() / "maze_test_3x2.txt";
+  {
+    std::ofstream file(path);
+    file << "o---o---o---o\r\n"
+            "|       |   |\r\n"
+            "o---o   o   o\r\n"
+            "|   |       |\r\n"
+            "o---o---o---o\r\n";
+  }
+  Maze maze({16, 16});
+  CHECK(maze.read_file(path.string()));
+  std::filesystem::remove(path);
+  CHECK(maze.width() == 3);
+  CHECK(maze.height() == 2);
+  CHECK(maze.is_wall({0, 0}, Direction::North));
+  CHECK(maze.is_wall({0, 0}, Direction::East));
+  CHECK(!maze.is_wall({1, 0}, Direction::North));
+  CHECK(!maze.is_wall({1, 0}, Direction::East));
+  CHECK(!maze.is_wall({0, 1}, Direction::East));
+  CHECK(maze.is_wall({1, 1}, Direction::East));
+  CHECK(!maze.is_wall({2, 1}, Direction::South));
+  for (int8_t y = 0; y < maze.height(); y++) {
+    for (int8_t x = 0; x < maze.width(); x++) {
+      CHECK(maze.is_visited({x, y}));
+    }
+  }
+  CHECK(!maze.read_file("/nonexistent/maze.txt"));
+}
+
+// 32x32の迷路で壁の参照・更新の速さを区画ごとの表現と比べる
+template <class M>
+void measure(const char *name, M &maze, const Maze &random) {
+  constexpr int REPEAT = 100;
+  constexpr int WALLS = maze::MAX_SIZE * maze::MAX_SIZE * 4;
+  int walls = 0;
+  const auto update_us = test::elapsed_us(
+      [&] {
+        for (int8_t y = 0; y < maze::MAX_SIZE; y++) {
+          for (int8_t x = 0; x < maze::MAX_SIZE; x++) {
+            for (int d = 0; d < 4; d++) {
+              const auto dir = static_cast<Direction>(d);
+              maze.set_wall({x, y}, dir, random.is_wall({x, y}, dir));
+            }
+          }
+        }
+      },
+      REPEAT);
+  const auto lookup_us = test::elapsed_us(
+      [&] {
+        for (int8_t y = 0; y < maze::MAX_SIZE; y++) {
+          for (int8_t x = 0; x < maze::MAX_SIZE; x++) {
+            for (int d = 0; d < 4; d++) {
+              walls += maze.is_wall({x, y}, static_cast<Direction>(d)) ? 1 : 0;
+            }
+          }
+        }
+      },
+      REPEAT);
+  std::printf(
+      "Maze: %s %d bytes, lookup %.1f Mops/s, update %.1f Mops/s (%d walls)\n",
+      name, static_cast<int>(sizeof(M)), WALLS / lookup_us,
+      WALLS / update_us, walls / REPEAT);
+}
+
+void benchmark() {
+  Maze random({32, 32});
+  test::randomMaze(random, 1);
+  Maze packed({32, 32});
+  CellMaze cells(32, 32);
+  measure("packed", packed, random);
+  measure("per-cell", cells, random);
+  // 共有する壁を1度だけ持つため、区画ごとの表現の半分に収まる
+  CHECK(sizeof(Maze) * 2 <= sizeof(CellMaze) + 16);
+  for (int8_t y = 0; y < 32; y++) {
+    for (int8_t x = 0; x < 32; x++) {
+      for (int d = 0; d < 4; d++) {
+        const auto dir = static_cast<Direction>(d);
+        CHECK(packed.is_wall({x, y}, dir) == cells.is_wall({x, y}, dir));
+      }
+    }
+  }
+}
+}  // namespace
+
+int main() {
+  checkReset();
+  checkSetWall();
+  checkReadFile();
+  benchmark();
+  return test::result();
+}
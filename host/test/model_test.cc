@@ -0,0 +1,103 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "fixture.h"
+#include "maze/maze.h"
+#include "maze/ranker.h"
+#include "model.h"
+#include "run.h"
+#include "trajectory.h"
+
+namespace {
+// 電池電圧 [V]
+constexpr float BATTERY = 4.0f;
+
+// 追従誤差
+struct Result {
+  float velocity_rms;
+  float angular_velocity_rms;
+  float distance;
+};
+
+// 軌道を車体・モータの閉ループで走る
+Result simulate(config::Config &conf,
+                const trajectory::Trajectory &trajectory, bool feedforward) {
+  const auto tire_rad = conf.tire_diameter / 2.0f / 1000.0f;
+  const auto track = conf.wheel_track_width / 1000.0f;
+  motion::Model model(conf);
+  test::Plant plant{
+      .tire_left = tire_rad, .tire_right = tire_rad, .track = track};
+  plant.mismatch();
+  float velo_sq = 0.0f;
+  float ang_velo_sq = 0.0f;
+  float length = 0.0f;
+  float target_length = 0.0f;
+  run::Target target{};
+  target.parameter.level = trajectory.level();
+  for (std::size_t i = 0; i < trajectory.size(); i++) {
+    trajectory.at(i, target);
+    // 前の周期の終わりの測定値で電圧を決める
+    const auto [left, right] = model.feedback(
+        target, plant.velocity * 1000.0f, plant.angular_velocity,
+        feedforward ? model.feedforward(target)
+                    : std::pair<float, float>{0.0f, 0.0f},
+        BATTERY);
+    plant.step(left, right);
+    length += plant.velocity * 1000.0f * motion::Model::PERIOD;
+    target_length += target.velocity * motion::Model::PERIOD;
+    const auto velo_err = plant.velocity * 1000.0f - target.velocity;
+    const auto ang_velo_err = plant.angular_velocity - target.angular_velocity;
+    velo_sq += velo_err * velo_err;
+    ang_velo_sq += ang_velo_err * ang_velo_err;
+  }
+  const auto n =
+      static_cast<float>(std::max<std::size_t>(trajectory.size(), 1));
+  return {std::sqrt(velo_sq / n), std::sqrt(ang_velo_sq / n),
+          length - target_length};
+}
+}  // namespace
+
+/**
+ * 車体・モータの閉ループを模擬し、フィードフォワードの有無で追従誤差を比べる
+ * (実機は質量・慣性モーメント・抵抗・摩擦がモデルとずれているものとする)
+ */
+int main() {
+  config::Config conf;
+  const maze::Position goal{static_cast<int8_t>(conf.maze_goal[0]),
+                            static_cast<int8_t>(conf.maze_goal[1])};
+  auto maze = std::make_unique<maze::Maze>(conf.maze_size);
+  test::openMaze(*maze, 3);
+
+  maze::Ranker ranker(conf);
+  trajectory::Trajectory trajectory;
+  for (auto level : {run::Level::Fast0, run::Level::Fast2, run::Level::Fast4}) {
+    CHECK(ranker.rank(*maze, goal, level));
+    CHECK(trajectory.bake(ranker.fastest().route));
+    const auto feedback = simulate(conf, trajectory, false);
+    const auto combined = simulate(conf, trajectory, true);
+    std::printf(
+        "Model: Fast%d velocity error rms %.1f / %.1f mm/s, "
+        "angular velocity error rms %.3f / %.3f rad/s, "
+        "distance error %.1f / %.1f mm (feedback only / feedforward)\n",
+        static_cast<int>(level) - static_cast<int>(run::Level::Fast0),
+        static_cast<double>(feedback.velocity_rms),
+        static_cast<double>(combined.velocity_rms),
+        static_cast<double>(feedback.angular_velocity_rms),
+        static_cast<double>(combined.angular_velocity_rms),
+        static_cast<double>(feedback.distance),
+        static_cast<double>(combined.distance));
+    // フィードフォワードを加えると追従誤差が半分以下になる
+    CHECK(combined.velocity_rms < feedback.velocity_rms * 0.5f);
+    CHECK(combined.angular_velocity_rms <
+          feedback.angular_velocity_rms * 0.5f);
+    CHECK(std::abs(combined.distance) <= std::abs(feedback.distance));
+  }
+  return test::result();
+}
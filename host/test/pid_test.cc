@@ -0,0 +1,127 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Project
+#include "check.h"
+#include "data/pid.h"
+#include "fixture.h"
+
+namespace {
+using Pid = data::Pid<float>;
+
+// 1次遅れの制御対象のゲイン [1/V]・時定数 [s]
+constexpr float PLANT_GAIN = 2.5f;
+constexpr float PLANT_LAG = 0.165f;
+// 出力の上限 [V]
+constexpr float LIMIT = 4.0f;
+
+// 制御対象を1周期分進める
+float plant(float y, float u, float dt) {
+  return y + (PLANT_GAIN * u - y) / PLANT_LAG * dt;
+}
+
+// 目標値1へのステップ応答 (行き過ぎ量・後半1/4の偏差の最大値・50msの値)
+struct Response {
+  float overshoot;
+  float error;
+  float early;
+};
+
+Response step(Pid &pid, float dt, float t, float limit) {
+  Response ret{0.0f, 0.0f, 0.0f};
+  float y = 0.0f;
+  const auto n = static_cast<int>(std::lround(t / dt));
+  for (int i = 0; i < n; i++) {
+    const auto u = pid.update(1.0f, y, 0.0f, -limit, limit);
+    y = plant(y, u, dt);
+    ret.overshoot = std::max(ret.overshoot, y - 1.0f);
+    if (i + 1 == static_cast<int>(std::lround(0.05f / dt))) {
+      ret.early = y;
+    }
+    if (i >= n * 3 / 4) {
+      ret.error = std::max(ret.error, std::abs(y - 1.0f));
+    }
+  }
+  return ret;
+}
+}  // namespace
+
+/**
+ * PID制御のステップ応答 (時間基準・積分の飽和対策・微分のフィルタ) と
+ * ゲインの切り替えを確認する
+ */
+int main() {
+  const Pid::Gain gain{2.0f, 20.0f, 0.0f};
+
+  // 積分により定常偏差が0になる
+  Pid pid(gain, 0.001f);
+  const auto settled = step(pid, 0.001f, 1.0f, LIMIT);
+  std::printf("Pid: step overshoot %.3f, settled error %.5f\n",
+              static_cast<double>(settled.overshoot),
+              static_cast<double>(settled.error));
+  CHECK(settled.error < 1e-3f);
+
+  // 連続時間のゲインのため、制御周期を変えても応答が一致する
+  Pid fine(gain, 0.0005f);
+  const auto half = step(fine, 0.0005f, 1.0f, LIMIT);
+  CHECK_NEAR(half.early, settled.early, 0.01f);
+
+  // 出力が飽和する大きなゲインで、積分を止めると行き過ぎが抑えられる
+  const Pid::Gain strong{1.0f, 200.0f, 0.0f};
+  constexpr float SATURATION = 0.6f;
+  Pid clamped(strong, 0.001f);
+  const auto with = step(clamped, 0.001f, 2.0f, SATURATION);
+  // 飽和を知らないPID制御 (出力の範囲外で制御対象の入力を飽和させる)
+  Pid unaware(strong, 0.001f);
+  float without = 0.0f;
+  float y = 0.0f;
+  for (int i = 0; i < 2000; i++) {
+    const auto u =
+        std::clamp(unaware.update(1.0f, y), -SATURATION, SATURATION);
+    y = plant(y, u, 0.001f);
+    without = std::max(without, y - 1.0f);
+  }
+  std::printf("Pid: saturated overshoot %.3f (anti-windup) / %.3f (none)\n",
+              static_cast<double>(with.overshoot),
+              static_cast<double>(without));
+  CHECK(with.overshoot < without * 0.5f);
+  CHECK(with.error < 1e-3f);
+
+  // 測定値の雑音に対する微分の出力の変動がフィルタで小さくなる
+  std::mt19937 rng(1);
+  std::normal_distribution<float> noise(0.0f, 0.01f);
+  float rms[2] = {0.0f, 0.0f};
+  for (int f = 0; f < 2; f++) {
+    Pid d({0.0f, 0.0f, 0.01f}, 0.001f, f == 0 ? 0.0f : 0.005f);
+    for (int i = 0; i < 1000; i++) {
+      const auto u = d.update(0.0f, noise(rng));
+      rms[f] += u * u;
+    }
+    rms[f] = std::sqrt(rms[f] / 1000.0f);
+  }
+  CHECK(rms[1] < rms[0] * 0.5f);
+
+  // ゲインを切り替えても出力が連続する
+  Pid bump(gain, 0.001f);
+  for (int i = 0; i < 100; i++) {
+    bump.update(1.0f, 0.5f);
+  }
+  const auto before = bump.update(1.0f, 0.5f);
+  bump.gain({2.0f, 80.0f, 0.0f});
+  const auto after = bump.update(1.0f, 0.5f);
+  CHECK_NEAR(after, before, 0.1f);
+
+  // 1回の更新の時間 (前回の出力を測定値に戻して最適化で省かれないようにする)
+  constexpr int UPDATES = 100000;
+  Pid timed(gain, 0.001f, 0.005f);
+  float u = 0.0f;
+  const auto update_us = test::elapsed_us(
+      [&] { u = timed.update(1.0f, u * 0.1f, 0.5f, -LIMIT, LIMIT); }, UPDATES);
+  std::printf("Pid: %.1f ns per update\n", update_us * 1000.0);
+  CHECK(std::isfinite(u));
+
+  return test::result();
+}
@@ -0,0 +1,111 @@
+// C++
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "maze/maze.h"
+#include "maze/planner.h"
+#include "run.h"
+
+namespace {
+// 角速度・角加速度・角躍度の制限の許容誤差 (比)
+constexpr float TOLERANCE = 1.001f;
+// 観測側の角速度の指令への1次遅れの時定数 [s]
+constexpr float LAG = 0.02f;
+// 角度を少なく見積もるジャイロの倍率
+constexpr float SCALE = 0.97f;
+// 制御周期 [s]
+constexpr float PERIOD = 0.001f;
+}  // namespace
+
+/**
+ * 超信地旋回(180度)が走行レベルごとの制限を守って指令の角度で終わるか、
+ * ジャイロの角度で終了を判定する場合は観測した角度が指令に達するまで
+ * 回り続けるかを確認する。
+ * 走行レベルごとに、旋回の所要時間と、区画境界から半区画で停止して旋回し
+ * 区画境界へ戻るまでの折り返しの時間を出力する。
+ */
+int main() {
+  const config::Config conf;
+  const auto angle = std::numbers::pi_v<float>;
+  const auto half = maze::CELL_SIZE / 2.0f;
+  run::Run run;
+  float prev_turnaround = INFINITY;
+  for (auto level : {run::Level::Fast0, run::Level::Fast1, run::Level::Fast2,
+                     run::Level::Fast3, run::Level::Fast4}) {
+    auto param = run::parameter(conf, run::Mode::PivotTurn, level);
+    param.angle = angle;
+
+    // 目標値のみ
+    run.reset();
+    run::Target target{};
+    int open_ticks = 0;
+    for (; open_ticks < 10000 && !run.finished(); open_ticks++) {
+      target = run.run(param);
+      CHECK(std::abs(target.angular_velocity) <=
+            param.max_angular_velocity * TOLERANCE);
+      CHECK(std::abs(target.angular_acceleration) <=
+            param.max_angular_acceleration * TOLERANCE);
+      CHECK(std::abs(target.angular_jerk) <=
+            param.max_angular_jerk * TOLERANCE);
+      CHECK_NEAR(target.velocity, 0.0f, 1e-6);
+    }
+    CHECK(run.finished());
+    CHECK_NEAR(target.angle, angle, 1e-4);
+    CHECK_NEAR(target.angular_velocity, 0.0f, 1e-4);
+
+    // 右旋回は符号のみ反転する
+    auto right = param;
+    right.angle = -angle;
+    run.reset();
+    for (int i = 0; i < 10000 && !run.finished(); i++) {
+      target = run.run(right);
+      CHECK(target.angular_velocity <= 0.0f);
+    }
+    CHECK_NEAR(target.angle, -angle, 1e-4);
+
+    // ジャイロで終了を判定する
+    run.reset();
+    float velocity = 0.0f;
+    float actual = 0.0f;
+    int ticks = 0;
+    for (; ticks < 10000; ticks++) {
+      run.measure(0.0f, actual * SCALE);
+      const auto &t = run.run(param);
+      if (run.finished()) {
+        break;
+      }
+      velocity += (t.angular_velocity - velocity) * PERIOD / LAG;
+      actual += velocity * PERIOD;
+    }
+    CHECK(run.finished());
+    CHECK(ticks < 10000);
+    // 観測した角度が指令に達するまで回り続ける
+    CHECK(actual * SCALE >= angle - 0.02f);
+    CHECK(actual > angle);
+
+    // 旋回速度で区画境界を通過し、半区画で停止・旋回して区画境界へ戻る
+    const auto straight = run::parameter(conf, run::Mode::Straight, level);
+    const auto turn_velocity =
+        run::parameter(conf, run::Mode::SlalomTurn, level).max_velocity;
+    const auto pivot = static_cast<float>(open_ticks) * PERIOD;
+    const auto stop =
+        maze::Planner::travel_time(half, turn_velocity, 0.0f, straight);
+    const auto start =
+        maze::Planner::travel_time(half, 0.0f, turn_velocity, straight);
+    const auto turnaround = stop + pivot + start;
+    std::printf(
+        "Pivot: Fast%d turn %.1f ms (gyro %.1f ms), turnaround %.1f ms\n",
+        static_cast<int>(level) - static_cast<int>(run::Level::Fast0),
+        static_cast<double>(pivot * 1000.0f),
+        static_cast<double>(static_cast<float>(ticks) * PERIOD * 1000.0f),
+        static_cast<double>(turnaround * 1000.0f));
+    // 走行レベルが上がるほど折り返しは短くなる
+    CHECK(turnaround <= prev_turnaround);
+    prev_turnaround = turnaround;
+  }
+  return test::result();
+}
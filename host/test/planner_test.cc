@@ -0,0 +1,152 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "fixture.h"
+#include "maze/compiler.h"
+#include "maze/maze.h"
+#include "maze/planner.h"
+#include "maze/ranker.h"
+#include "run.h"
+
+namespace {
+constexpr run::Level LEVELS[] = {run::Level::Fast0, run::Level::Fast1,
+                                 run::Level::Fast2, run::Level::Fast3,
+                                 run::Level::Fast4};
+
+// スタート区画からゴール区画まで隣接する区画を重複なくたどる
+bool connected(const maze::Planner::Path &path, maze::Position goal) {
+  if (path.empty() || path.front() != maze::Position(0, 0) ||
+      path.back() != goal) {
+    return false;
+  }
+  for (std::size_t i = 1; i < path.size(); i++) {
+    const auto dx = std::abs(path[i].x - path[i - 1].x);
+    const auto dy = std::abs(path[i].y - path[i - 1].y);
+    if (dx + dy != 1) return false;
+    for (std::size_t j = 0; j < i; j++) {
+      if (path[j] == path[i]) return false;
+    }
+  }
+  return true;
+}
+
+// 北へ一直線の迷路では直進1回の走行時間となる
+void checkStraight(const config::Config &conf) {
+  maze::Maze maze({1, 8});
+  for (int8_t y = 0; y < 7; y++) {
+    maze.set_wall({0, y}, maze::Direction::North, false);
+  }
+  maze::Planner planner(conf);
+  CHECK(planner.plan(maze, {0, 7}, run::Level::Fast0));
+  const auto straight =
+      run::parameter(conf, run::Mode::Straight, run::Level::Fast0);
+  CHECK_NEAR(planner.time(),
+             maze::Planner::travel_time(7 * maze::CELL_SIZE, 0.0f, 0.0f,
+                                        straight),
+             1e-4);
+  CHECK(connected(planner.path(), {0, 7}));
+  CHECK(planner.path().size() == 8);
+
+  // 未観測の壁は通れない
+  maze::Maze closed({1, 8});
+  CHECK(!planner.plan(closed, {0, 7}, run::Level::Fast0));
+  CHECK(!std::isfinite(planner.time()));
+  CHECK(planner.path().empty());
+}
+
+// 全ての壁を観測済みとした迷路で、走行レベルが上がるほど速くなる
+void checkLevels(const config::Config &conf) {
+  const maze::Position goal{7, 7};
+  maze::Maze maze({16, 16});
+  test::openMaze(maze, 3);
+
+  maze::Planner planner(conf);
+  maze::Compiler compiler(conf);
+  maze::Ranker ranker(conf);
+  float prev = INFINITY;
+  for (auto level : LEVELS) {
+    CHECK(planner.plan(maze, goal, level));
+    CHECK(std::isfinite(planner.time()) && planner.time() > 0.0f);
+    CHECK(planner.time() <= prev);
+    prev = planner.time();
+    // 区画の経路に戻して走行モードの列に変換できる
+    CHECK(connected(planner.path(), goal));
+    CHECK(compiler.compile(planner.path(), level));
+
+    // 走行時間が最小の経路は候補に含まれ、それより遅くならない
+    CHECK(ranker.rank(maze, goal, level));
+    CHECK(ranker.fastest().time <= compiler.time() + 1e-4f);
+    const auto &candidates = ranker.candidates();
+    CHECK(!candidates.empty());
+    CHECK(static_cast<int>(candidates.size()) <=
+          maze::Ranker::MAX_CANDIDATES);
+    for (std::size_t i = 1; i < candidates.size(); i++) {
+      CHECK(candidates[i - 1].time <= candidates[i].time);
+    }
+    CHECK(!ranker.fastest().route.empty());
+    CHECK(ranker.fastest().path.front() == maze::Position(0, 0));
+    CHECK(ranker.fastest().path.back() == goal);
+    CHECK(!ranker.safer().route.empty());
+    for (const auto &candidate : candidates) {
+      CHECK(ranker.safer().turns <= candidate.turns);
+    }
+  }
+}
+
+// 32x32の迷路で走行レベルごとの計算時間を計測する
+void benchmark(const config::Config &conf) {
+  const maze::Position goal{15, 15};
+  maze::Maze maze({32, 32});
+  test::openMaze(maze, 5);
+
+  maze::Planner planner(conf);
+  maze::Ranker ranker(conf);
+  for (auto level : LEVELS) {
+    bool found = false;
+    const auto us =
+        test::elapsed_us([&] { found = planner.plan(maze, goal, level); });
+    CHECK(found);
+    CHECK(connected(planner.path(), goal));
+    std::printf("Planner: 32x32 Fast%d %.3f s, %d cells, %.0f us\n",
+                static_cast<int>(level) - static_cast<int>(run::Level::Fast0),
+                static_cast<double>(planner.time()),
+                static_cast<int>(planner.path().size()), us);
+
+    // 計算時間の上限に収まり、列挙を打ち切らない
+    CHECK(ranker.rank(maze, goal, level));
+    CHECK(!ranker.truncated());
+    CHECK(ranker.elapsed_us() < maze::Ranker::BUDGET_US);
+    std::printf("Ranker: 32x32 Fast%d %d candidates, %lld us (budget %lld)\n",
+                static_cast<int>(level) - static_cast<int>(run::Level::Fast0),
+                static_cast<int>(ranker.candidates().size()),
+                static_cast<long long>(ranker.elapsed_us()),
+                static_cast<long long>(maze::Ranker::BUDGET_US));
+  }
+
+  // 上限を超えたら列挙を打ち切り、最初の経路と時間が最小の経路で順位付けする
+  CHECK(ranker.rank(maze, goal, run::Level::Fast0,
+                    maze::Ranker::MAX_CANDIDATES, 0));
+  CHECK(ranker.truncated());
+  CHECK(!ranker.candidates().empty() && ranker.candidates().size() <= 2);
+  CHECK(planner.plan(maze, goal, run::Level::Fast0));
+  CHECK(std::find_if(ranker.candidates().begin(), ranker.candidates().end(),
+                     [&](const maze::Ranker::Candidate &c) {
+                       return c.path == planner.path();
+                     }) != ranker.candidates().end());
+}
+}  // namespace
+
+int main() {
+  const config::Config conf;
+  checkStraight(conf);
+  checkLevels(conf);
+  benchmark(conf);
+  return test::result();
+}
@@ -0,0 +1,136 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <numbers>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "fixture.h"
+#include "maze/compiler.h"
+#include "maze/maze.h"
+#include "model.h"
+#include "run.h"
+#include "tracker.h"
+#include "trajectory.h"
+
+namespace {
+// 電池電圧 [V]
+constexpr float BATTERY = 4.0f;
+// 姿勢の補正で増えてよい角度のずれ [rad]
+constexpr float MAX_STEER = 1.5f * std::numbers::pi_v<float> / 180.0f;
+
+// 計画した経路からの横ずれ [mm]・角度のずれ [rad] の最大値と走り終えた値
+struct Result {
+  float max_lateral;
+  float max_heading;
+  float lateral;
+  float heading;
+};
+
+/**
+ * 左右のタイヤの直径が逆向きにずれた車体で軌道を走る
+ * @param mismatch 左右の直径の差の割合 (平均は設定の値)
+ * @param track_pose 姿勢の偏差で目標値を補正するか
+ */
+Result simulate(config::Config &conf,
+                const trajectory::Trajectory &trajectory, float mismatch,
+                bool track_pose) {
+  const auto tire_rad = conf.tire_diameter / 2.0f / 1000.0f;
+  const auto track = conf.wheel_track_width / 1000.0f;
+  motion::Model model(conf);
+  motion::Tracker tracker(conf);
+  test::Plant plant{.tire_left = tire_rad * (1.0f + mismatch / 2.0f),
+                    .tire_right = tire_rad * (1.0f - mismatch / 2.0f),
+                    .track = track};
+  plant.mismatch();
+  // オドメトリの姿勢と、目標値を積分した計画上の姿勢 [mm], [rad]
+  float odom_x = 0.0f;
+  float odom_y = 0.0f;
+  float ideal_x = 0.0f;
+  float ideal_y = 0.0f;
+  float ideal_angle = 0.0f;
+  Result result{};
+  run::Target target{};
+  target.parameter.level = trajectory.level();
+  for (std::size_t i = 0; i < trajectory.size(); i++) {
+    trajectory.at(i, target);
+    const auto velocity = plant.measured_velocity(tire_rad);
+    const auto &command =
+        track_pose ? tracker.track(target, odom_x, odom_y, plant.angle)
+                   : target;
+    const auto [left, right] =
+        model.feedback(command, velocity, plant.angular_velocity,
+                       model.feedforward(command), BATTERY);
+    const auto previous = plant.angle;
+    plant.step(left, right);
+    // 測定した速度とジャイロの角度で位置を推定する
+    const auto mid = (previous + plant.angle) / 2.0f;
+    const auto measured =
+        plant.measured_velocity(tire_rad) * motion::Model::PERIOD;
+    odom_x += measured * std::cos(mid);
+    odom_y += measured * std::sin(mid);
+
+    const auto distance = target.velocity * motion::Model::PERIOD;
+    const auto turn = target.angular_velocity * motion::Model::PERIOD;
+    ideal_x += distance * std::cos(ideal_angle + turn / 2.0f);
+    ideal_y += distance * std::sin(ideal_angle + turn / 2.0f);
+    ideal_angle += turn;
+    // 計画上の進行方向に対する実際の位置の横ずれと角度のずれ
+    result.lateral = -std::sin(ideal_angle) * (plant.x - ideal_x) +
+                     std::cos(ideal_angle) * (plant.y - ideal_y);
+    result.heading = plant.angle - ideal_angle;
+    result.max_lateral = std::max(result.max_lateral, std::abs(result.lateral));
+    result.max_heading = std::max(result.max_heading, std::abs(result.heading));
+  }
+  return result;
+}
+}  // namespace
+
+/**
+ * 左右のタイヤの直径が逆向きにずれた車体で、姿勢の補正の有無による
+ * 計画した経路からの横ずれ・角度のずれを比べる
+ * (オドメトリは設定の直径で車輪の速度を求め、角度はジャイロで正しく測る。
+ *  直径の平均のずれは距離の縮尺の誤差となり、オドメトリでは測れない)
+ */
+int main() {
+  config::Config conf;
+  const maze::Position goal{static_cast<int8_t>(conf.maze_goal[0]),
+                            static_cast<int8_t>(conf.maze_goal[1])};
+  auto maze = std::make_unique<maze::Maze>(conf.maze_size);
+  test::openMaze(*maze, 3);
+
+  maze::Compiler compiler(conf);
+  const auto path = maze::Compiler::path(*maze, goal);
+  trajectory::Trajectory trajectory;
+  for (auto level : {run::Level::Fast0, run::Level::Fast4}) {
+    CHECK(compiler.compile(path, level));
+    CHECK(trajectory.bake(compiler.route()));
+    for (auto mismatch : {0.0f, 0.01f, 0.02f}) {
+      const auto loops = simulate(conf, trajectory, mismatch, false);
+      const auto tracking = simulate(conf, trajectory, mismatch, true);
+      std::printf(
+          "Pose: Fast%d tire diff %.0f%%, lateral error max %.2f / %.2f mm "
+          "(end %.2f / %.2f mm), heading error max %.2f / %.2f deg "
+          "(velocity loops / tracking)\n",
+          static_cast<int>(level) - static_cast<int>(run::Level::Fast0),
+          static_cast<double>(mismatch * 100.0f),
+          static_cast<double>(loops.max_lateral),
+          static_cast<double>(tracking.max_lateral),
+          static_cast<double>(loops.lateral),
+          static_cast<double>(tracking.lateral),
+          static_cast<double>(loops.max_heading * 180.0f /
+                              std::numbers::pi_v<float>),
+          static_cast<double>(tracking.max_heading * 180.0f /
+                              std::numbers::pi_v<float>));
+      // 姿勢の補正で横ずれが小さくなり、走り終えるまでにほぼ戻る
+      CHECK(tracking.max_lateral < loops.max_lateral * 0.7f);
+      CHECK(std::abs(tracking.lateral) < 0.5f);
+      // 経路へ戻るために向ける分だけ角度のずれは大きくなる
+      CHECK(tracking.max_heading < loops.max_heading + MAX_STEER);
+    }
+  }
+  return test::result();
+}
@@ -0,0 +1,132 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "maze/maze.h"
+#include "run.h"
+#include "slalom.h"
+
+namespace {
+using run::Mode;
+
+struct Case {
+  Mode mode;
+  // 前の走行モード (斜めから始まるか)
+  Mode before;
+  // 区画境界の始点から見た終点 [mm]
+  float forward;
+  float left;
+};
+
+// 終点の位置の許容誤差 [mm]
+constexpr float TOLERANCE = 0.5f;
+// 角速度・角加速度の制限に対する許容誤差の割合 (表の補間・丸め)
+constexpr float LIMIT_TOLERANCE = 1e-3f;
+
+constexpr run::Level LEVELS[] = {run::Level::Fast0, run::Level::Fast1,
+                                 run::Level::Fast2, run::Level::Fast3,
+                                 run::Level::Fast4};
+
+// 角速度・角加速度が走行レベルの制限以下か
+bool within(float angular_velocity, float angular_acceleration,
+            const run::Parameter &param) {
+  return std::abs(angular_velocity) <=
+             param.max_angular_velocity * (1.0f + LIMIT_TOLERANCE) &&
+         std::abs(angular_acceleration) <=
+             param.max_angular_acceleration * (1.0f + LIMIT_TOLERANCE);
+}
+
+// 全ての形状・走行レベルで、抑えた旋回速度では表の全ての値が制限以下となる
+void checkTable(const config::Config &conf) {
+  for (auto level : LEVELS) {
+    const auto param = run::parameter(conf, Mode::SlalomTurn, level);
+    for (const auto &profile : slalom::PROFILES) {
+      const auto v = slalom::velocity(profile, param);
+      CHECK(v > 0.0f && v <= param.max_velocity);
+      const auto k = v / profile.radius;
+      const auto rate = v / profile.length;
+      for (const auto &entry : slalom::TABLE) {
+        CHECK(within(k * entry.curvature, k * rate * entry.slope, param));
+      }
+    }
+  }
+}
+}  // namespace
+
+/**
+ * スラローム旋回の目標値を積分し、区画境界の終点に着くかを
+ * 走行レベルごとに確認する。
+ * 角速度の最大は旋回速度と最大曲率の半径で決まるため、旋回速度を
+ * slalom::velocity() で抑え、走行レベルの角速度・角加速度の制限を
+ * 全ての周期で守ることも確認する。
+ */
+int main() {
+  const auto half = maze::CELL_SIZE / 2.0f;
+  const auto diagonal = maze::CELL_SIZE / std::numbers::sqrt2_v<float>;
+  const Case cases[] = {
+      {Mode::SlalomTurnLeft45, Mode::Straight, half, half},
+      {Mode::SlalomTurnLeft90, Mode::Straight, half, half},
+      {Mode::SlalomTurnLeft135, Mode::Straight, 0.0f, maze::CELL_SIZE},
+      {Mode::SlalomTurnLeft180, Mode::Straight, 0.0f, maze::CELL_SIZE},
+      {Mode::SlalomTurnVLeft90, Mode::Diagonal, diagonal, diagonal},
+  };
+  const config::Config conf;
+  checkTable(conf);
+  run::Run run;
+  float max_error = 0.0f;
+  int violations = 0;
+  for (auto level : LEVELS) {
+    for (const auto &c : cases) {
+      // 前の走行モードで向きを設定する
+      auto prev = run::parameter(conf, c.before, level);
+      run.reset();
+      run.run(prev);
+
+      auto param = run::parameter(conf, c.mode, level);
+      const auto profile = slalom::profile(c.mode, c.before == Mode::Diagonal);
+      param.start_velocity = slalom::velocity(profile, param);
+      param.end_velocity = param.start_velocity;
+      run.reset();
+      // 負の前後の直進は旋回の外で走行したものとして加える
+      float x = std::min(profile.before, 0.0f);
+      float y = 0.0f;
+      float angle = 0.0f;
+      float length = 0.0f;
+      float peak = 0.0f;
+      for (int i = 0; i < 10000 && !run.finished(); i++) {
+        const auto &target = run.run(param);
+        CHECK_NEAR(target.velocity, param.start_velocity, 1e-3);
+        peak = std::max(peak, std::abs(target.angular_velocity));
+        if (!within(target.angular_velocity, target.angular_acceleration,
+                    param)) {
+          violations++;
+        }
+        const auto ds = target.length - length;
+        const auto mid = (angle + target.angle) / 2.0f;
+        x += ds * std::cos(mid);
+        y += ds * std::sin(mid);
+        angle = target.angle;
+        length = target.length;
+      }
+      CHECK(run.finished());
+      CHECK_NEAR(peak, param.start_velocity / profile.radius,
+                 0.01f * peak);
+      CHECK_NEAR(length, profile.travel(), 1e-3);
+      CHECK_NEAR(angle, profile.angle, 1e-4);
+      x += std::min(profile.after, 0.0f) * std::cos(angle);
+      y += std::min(profile.after, 0.0f) * std::sin(angle);
+      const auto error = std::hypot(x - c.forward, y - c.left);
+      CHECK(error <= TOLERANCE);
+      max_error = std::max(max_error, error);
+    }
+  }
+  std::printf("Slalom: end error %.3f mm, %d ticks over angular limits\n",
+              static_cast<double>(max_error), violations);
+  CHECK(violations == 0);
+  return test::result();
+}
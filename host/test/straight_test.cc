@@ -0,0 +1,124 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "data/scurve.h"
+#include "fixture.h"
+#include "run.h"
+#include "trajectory.h"
+
+namespace {
+// 加速度・躍度・速度の制限の許容誤差 (比)
+constexpr float TOLERANCE = 1.001f;
+
+// 距離が足りない場合は終了速度を変えて feasible() で知らせる
+void checkFeasible() {
+  data::SCurve curve;
+  curve.reset(90.0f, 0.0f, 300.0f, 1000.0f, 5000.0f, 100000.0f);
+  CHECK(curve.feasible());
+  CHECK_NEAR(curve.end_velocity(), 300.0f, 1e-3);
+
+  // 減速しきれなければ終了速度を上げる
+  curve.reset(5.0f, 1000.0f, 0.0f, 1000.0f, 5000.0f, 100000.0f);
+  CHECK(!curve.feasible());
+  CHECK(curve.end_velocity() > 0.0f);
+  CHECK(curve.end_velocity() < 1000.0f);
+  CHECK_NEAR(curve.at(curve.duration()).position, 5.0f, 1e-3);
+
+  // 加速しきれなければ終了速度を下げる
+  curve.reset(5.0f, 0.0f, 1000.0f, 1000.0f, 5000.0f, 100000.0f);
+  CHECK(!curve.feasible());
+  CHECK(curve.end_velocity() < 1000.0f);
+}
+
+// 制限を守って距離を走り切り、終了速度まで加減速できなければ知らせる
+void checkStraight(const config::Config &conf) {
+  const std::pair<float, float> velocities[] = {
+      {0.0f, 0.0f}, {0.0f, 300.0f}, {300.0f, 0.0f}, {300.0f, 300.0f}};
+  run::Run run;
+  for (auto level : {run::Level::Fast0, run::Level::Fast2, run::Level::Fast4}) {
+    for (float length : {5.0f, 45.0f, 90.0f, 450.0f, 1800.0f}) {
+      for (auto [v0, v1] : velocities) {
+        auto param = run::parameter(conf, run::Mode::Straight, level);
+        param.length = length;
+        param.start_velocity = v0;
+        param.end_velocity = v1;
+        data::SCurve curve;
+        curve.reset(length, v0, v1, param.max_velocity,
+                    param.max_acceleration, param.max_jerk);
+
+        run.reset();
+        run::Target target{};
+        int ticks = 0;
+        do {
+          target = run.run(param);
+          CHECK(std::abs(target.acceleration) <=
+                param.max_acceleration * TOLERANCE);
+          CHECK(std::abs(target.jerk) <= param.max_jerk * TOLERANCE);
+          CHECK(target.velocity <=
+                std::max({param.max_velocity, v0, v1}) * TOLERANCE);
+        } while (!run.finished() && ++ticks < 10000);
+        CHECK(run.finished());
+        CHECK(run.feasible() == curve.feasible());
+        CHECK_NEAR(target.length, length, 1e-2);
+        if (run.feasible()) {
+          CHECK_NEAR(target.velocity, v1, 1e-2);
+        }
+      }
+    }
+  }
+}
+
+// 加減速しきれない直進を含む経路は焼き込まない
+void checkBake(const config::Config &conf) {
+  auto param = run::parameter(conf, run::Mode::Straight, run::Level::Fast0);
+  param.length = 90.0f;
+  param.start_velocity = 0.0f;
+  param.end_velocity = 0.0f;
+  trajectory::Trajectory baked;
+  CHECK(baked.bake({param}));
+
+  param.length = 5.0f;
+  param.start_velocity = param.max_velocity;
+  CHECK(!baked.bake({param}));
+  CHECK(baked.segments() == 0);
+}
+
+// 1周期あたりの目標値の計算時間を直進の距離ごとに計測する
+// (経過時間から解析的に求めるため、距離によらずほぼ一定となる)
+void benchmark(const config::Config &conf) {
+  run::Run run;
+  for (float length : {90.0f, 1800.0f}) {
+    auto param = run::parameter(conf, run::Mode::Straight, run::Level::Fast4);
+    param.length = length;
+    param.start_velocity = 0.0f;
+    param.end_velocity = 0.0f;
+    run.reset();
+    int ticks = 0;
+    const auto us = test::elapsed_us([&] {
+      while (!run.finished() && ticks < 10000) {
+        run.run(param);
+        ticks++;
+      }
+    });
+    CHECK(run.finished());
+    std::printf("Straight: Fast4 %.0f mm, %d ticks, %.3f us per tick\n",
+                static_cast<double>(length), ticks, us / ticks);
+  }
+}
+}  // namespace
+
+int main() {
+  const config::Config conf;
+  checkFeasible();
+  checkStraight(conf);
+  checkBake(conf);
+  benchmark(conf);
+  return test::result();
+}
@@ -0,0 +1,108 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "fixture.h"
+#include "maze/maze.h"
+#include "maze/ranker.h"
+#include "run.h"
+
+namespace {
+// 制御周期 [s]
+constexpr float PERIOD = 0.001f;
+// 速度の応答の時定数 [s] と、出せる加速度の目標の最大加速度に対する割合
+constexpr float LAG = 0.02f;
+constexpr float SATURATION = 0.8f;
+
+// 旋回の開始時の位置の遅れ・走り終えた位置の誤差 [mm]
+struct Result {
+  float max_entry;
+  float mean_entry;
+  float end;
+};
+
+/**
+ * 目標速度に1次遅れで追従し、加速度が飽和する車体で経路を走る
+ * @param track 測定した距離で目標値を引くか (falseなら経過時間)
+ */
+Result simulate(const maze::Ranker::Route &route, bool track) {
+  // motion::Motion と同様に走行モードを繋ぎ、距離は境界から数える
+  run::Run run;
+  float velocity = 0.0f;
+  float travelled = 0.0f;
+  float boundary = 0.0f;
+  float target_velocity = 0.0f;
+  Result result{};
+  int turns = 0;
+  int ticks = 0;
+  for (std::size_t i = 0; i < route.size(); i++) {
+    auto param = route[i];
+    param.track_distance = track;
+    const auto straight = param.mode == run::Mode::Straight ||
+                          param.mode == run::Mode::Diagonal;
+    if (i > 0 && straight) {
+      param.start_velocity = target_velocity;
+    }
+    if (!straight) {
+      const auto error = std::abs(boundary - travelled);
+      result.max_entry = std::max(result.max_entry, error);
+      result.mean_entry += error;
+      turns++;
+    }
+    run.reset();
+    do {
+      run.measure(travelled - boundary, 0.0f);
+      const auto &target = run.run(param);
+      const auto limit = SATURATION * param.max_acceleration;
+      velocity +=
+          std::clamp((target.velocity - velocity) / LAG, -limit, limit) *
+          PERIOD;
+      travelled += velocity * PERIOD;
+      target_velocity = target.velocity;
+      ticks++;
+    } while (!run.finished() && ticks < 60'000);
+    CHECK(run.finished());
+    boundary += param.length;
+  }
+  result.mean_entry /= static_cast<float>(std::max(turns, 1));
+  result.end = travelled - boundary;
+  return result;
+}
+}  // namespace
+
+/**
+ * 応答の遅れる車体で最速の経路を走り、測定した距離で目標値を引くと
+ * 経過時間で引く場合より旋回の開始位置の遅れが小さくなるか確認する
+ */
+int main() {
+  const config::Config conf;
+  const maze::Position goal{7, 7};
+  maze::Maze maze(conf.maze_size);
+  test::openMaze(maze, 3);
+
+  maze::Ranker ranker(conf);
+  for (auto level : {run::Level::Fast0, run::Level::Fast2, run::Level::Fast4}) {
+    CHECK(ranker.rank(maze, goal, level));
+    const auto &route = ranker.fastest().route;
+    const auto time = simulate(route, false);
+    const auto distance = simulate(route, true);
+    std::printf(
+        "Tracking: Fast%d turn entry error %.2f mm by time, %.2f mm by "
+        "distance (mean %.2f mm, %.2f mm)\n",
+        static_cast<int>(level) - static_cast<int>(run::Level::Fast0),
+        static_cast<double>(time.max_entry),
+        static_cast<double>(distance.max_entry),
+        static_cast<double>(time.mean_entry),
+        static_cast<double>(distance.mean_entry));
+    CHECK(distance.max_entry < time.max_entry);
+    CHECK(distance.mean_entry < time.mean_entry);
+    // 目標は測定値より先行量 (2mm) までしか進まない
+    CHECK(distance.max_entry <= 3.0f);
+    CHECK(std::abs(distance.end) <= 3.0f);
+  }
+  return test::result();
+}
@@ -0,0 +1,77 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Project
+#include "check.h"
+#include "config.h"
+#include "fixture.h"
+#include "maze/maze.h"
+#include "maze/ranker.h"
+#include "run.h"
+#include "trajectory.h"
+
+/**
+ * 全ての壁を観測済みとした迷路の最速の経路を焼き込み、
+ * motion::Motion と同様に走行モードを繋いで生成した目標値と
+ * 読み出した目標値が量子化の誤差の範囲で一致するか確認する
+ */
+int main() {
+  const config::Config conf;
+  const maze::Position goal{7, 7};
+  maze::Maze maze(conf.maze_size);
+  test::openMaze(maze, 3);
+
+  maze::Ranker ranker(conf);
+  for (auto level : {run::Level::Fast0, run::Level::Fast2, run::Level::Fast4}) {
+    CHECK(ranker.rank(maze, goal, level));
+    const auto &route = ranker.fastest().route;
+    trajectory::Trajectory baked;
+    CHECK(baked.bake(route));
+    CHECK(baked.segments() == route.size());
+    CHECK(baked.level() == route.front().level);
+    CHECK(baked.size() == baked.end(baked.segments() - 1));
+    CHECK(baked.bytes() >= baked.size() * sizeof(trajectory::Setpoint));
+
+    run::Run run;
+    run::Target streamed{};
+    float max_error = 0.0f;
+    float velocity = 0.0f;
+    std::size_t index = 0;
+    for (std::size_t i = 0; i < route.size(); i++) {
+      auto param = route[i];
+      if (i > 0 && (param.mode == run::Mode::Straight ||
+                    param.mode == run::Mode::Diagonal)) {
+        param.start_velocity = velocity;
+      }
+      run.reset();
+      // 走行モードごとに出し終えた周期で区切られる
+      CHECK(index < baked.end(i));
+      for (; index < baked.end(i); index++) {
+        const auto &target = run.run(param);
+        velocity = target.velocity;
+        baked.at(index, streamed);
+        CHECK_NEAR(streamed.velocity, target.velocity,
+                   trajectory::Trajectory::VELOCITY_LSB / 2.0f + 1e-4f);
+        CHECK_NEAR(streamed.angular_velocity, target.angular_velocity,
+                   trajectory::Trajectory::ANGULAR_VELOCITY_LSB / 2.0f +
+                       1e-6f);
+        max_error = std::max(
+            max_error, std::abs(streamed.velocity - target.velocity));
+      }
+      CHECK(run.finished());
+    }
+    CHECK_NEAR(streamed.velocity, 0.0f, 1e-6);
+    std::printf("Trajectory: Fast%d %.3f s, %d bytes, velocity error %.3f\n",
+                static_cast<int>(level) - static_cast<int>(run::Level::Fast0),
+                static_cast<double>(baked.duration()),
+                static_cast<int>(baked.bytes()),
+                static_cast<double>(max_error));
+
+    baked.clear();
+    CHECK(baked.size() == 0);
+    CHECK(baked.segments() == 0);
+  }
+  return test::result();
+}
@@ -1,29 +1,236 @@
 // C++
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <queue>
+#include <random>
+#include <utility>
 
 // ESP-IDF
+#include <esp_cpu.h>
 #include <esp_log.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
 // Project
 #include "config.h"
+#include "data/pid.h"
 #include "driver/driver.h"
+#include "maze/flood.h"
+#include "maze/maze.h"
+#include "maze/ranker.h"
 #include "motion.h"
 #include "odometry.h"
+#include "run.h"
+#include "search.h"
 #include "sensor.h"
+#include "trajectory.h"
+#include "ui.h"
 
 static constexpr auto TAG = "mm-bluelight";
+// 探索の再開を確定するまで待つ時間 [ms]
+static constexpr uint32_t WARM_CONFIRM_TIMEOUT_MS = 30'000;
+// 最短走行の走行レベルの数 (Fast0 ~ Fast4)
+static constexpr int FAST_LEVELS = 5;
 
 motion::Motion *mot = nullptr;
 odometry::Odometry *odom = nullptr;
 driver::Driver *dri = nullptr;
 config::Config *conf = nullptr;
 sensor::Sensor *sens = nullptr;
+search::Search *srch = nullptr;
+ui::Ui *menu = nullptr;
 
 void calibrateImu() { dri->imu->calibration(); }
 
+// スタートからゴールまで探索し、スタートへ戻る
+void searchMaze(search::Resume resume) {
+  sens->start(8192, 20, 0);
+  mot->start(8192, 20, 0);
+  if (srch->run(resume)) {
+    dri->buzzer->set(driver::hardware::Buzzer::Mode::SearchSuccess, false);
+  } else {
+    dri->buzzer->set(driver::hardware::Buzzer::Mode::SearchFailed, false);
+  }
+  mot->stop();
+  sens->stop();
+  dri->buzzer->update();
+}
+
+// 探索済みの迷路で最短経路を走行する (スタート区画で待機中に軌道を焼き込む)
+void fastRun(const maze::Maze &maze, run::Level level) {
+  const maze::Position goal{static_cast<int8_t>(conf->maze_goal[0]),
+                            static_cast<int8_t>(conf->maze_goal[1])};
+  maze::Ranker ranker(*conf);
+  if (!ranker.rank(maze, goal, level)) {
+    ESP_LOGW(TAG, "Fast run: no route to goal");
+    return;
+  }
+  auto baked = std::make_unique<trajectory::Trajectory>();
+  if (!baked->bake(ranker.fastest().route)) {
+    ESP_LOGW(TAG, "Fast run: failed to bake trajectory");
+    return;
+  }
+  ESP_LOGI(TAG, "Fast run: %d segments, %.3f s, %d bytes, ranked in %lld us%s",
+           static_cast<int>(baked->segments()),
+           static_cast<double>(baked->duration()),
+           static_cast<int>(baked->bytes()), ranker.elapsed_us(),
+           ranker.truncated() ? " (truncated)" : "");
+
+  sens->start(8192, 20, 0);
+  mot->start(8192, 20, 0);
+  odom->reset();
+  mot->stream(*baked);
+  const auto timeout =
+      pdMS_TO_TICKS(static_cast<uint32_t>(baked->duration() * 1000.0f) + 1000);
+  motion::Progress progress{};
+  for (std::size_t i = 0; i < baked->segments(); i++) {
+    if (!mot->wait(progress, timeout)) {
+      ESP_LOGW(TAG, "Fast run: timed out at segment %d", static_cast<int>(i));
+      break;
+    }
+  }
+  mot->stop();
+  sens->stop();
+}
+
+// センサ取得・制御のタスクを周波数ごとに2秒動かし、周期のばらつきと
+// センサ値の取得開始からモータ出力までの遅延を比べる
+// (実機のタイマ・タスクの計測のため、起動時のメニューから実行する)
+void benchmarkTimer() {
+  const auto frequency = conf->control_frequency;
+  for (const int hz : {1000, 2000, 4000}) {
+    conf->control_frequency = hz;
+    sens->start(8192, 20, 0);
+    mot->start(8192, 20, 0);
+    vTaskDelay(pdMS_TO_TICKS(2000));
+    mot->stop();
+    sens->stop();
+    for (const auto &[name, jitter] :
+         {std::pair{"Sensor", sens->jitter()}, {"Motion", mot->jitter()}}) {
+      ESP_LOGI(TAG,
+               "Timer: %s %d Hz, %lu periods, %lu missed, latency %.1f us "
+               "(max %.1f us), period %.1f ~ %.1f us",
+               name, hz, jitter.periods, jitter.missed,
+               static_cast<double>(jitter.latency_mean),
+               static_cast<double>(jitter.latency_max),
+               static_cast<double>(jitter.period_min),
+               static_cast<double>(jitter.period_max));
+    }
+    const auto latency = mot->latency();
+    ESP_LOGI(TAG, "Timer: %d Hz, sample to PWM %.1f us (max %.1f us)", hz,
+             static_cast<double>(latency.mean),
+             static_cast<double>(latency.max));
+  }
+  conf->control_frequency = frequency;
+}
+
+// 歩数マップの更新のサイクル数を、キューによる区画ごとの幅優先探索と比べる
+// (ホストでは時間のみ比べるため、実機のCPUで起動時のメニューから実行する)
+void benchmarkFlood() {
+  static constexpr int ITERATIONS = 100;
+  const maze::Position goal{static_cast<int8_t>(conf->maze_goal[0]),
+                            static_cast<int8_t>(conf->maze_goal[1])};
+  auto maze = std::make_unique<maze::Maze>(conf->maze_size);
+  auto flood = std::make_unique<maze::Flood>();
+  auto queue_distance = std::make_unique<
+      std::array<std::array<uint16_t, maze::MAX_SIZE>, maze::MAX_SIZE>>();
+
+  // 乱数で壁を配置する (ホストのテストと同じ配置)
+  std::minstd_rand rand(1);
+  const auto cells = maze->width() * maze->height();
+  for (int i = 0; i < cells * 2; i++) {
+    maze::Position pos{static_cast<int8_t>(rand() % maze->width()),
+                       static_cast<int8_t>(rand() % maze->height())};
+    maze->set_wall(pos, static_cast<maze::Direction>(rand() % 4),
+                   rand() % 3 == 0);
+  }
+
+  const auto goals = maze::Flood::cells({goal});
+  auto begin = esp_cpu_get_cycle_count();
+  for (int i = 0; i < ITERATIONS; i++) {
+    flood->update(*maze, goals, maze::Flood::Unknown::Open);
+  }
+  const auto flood_cycles = (esp_cpu_get_cycle_count() - begin) / ITERATIONS;
+
+  begin = esp_cpu_get_cycle_count();
+  for (int i = 0; i < ITERATIONS; i++) {
+    auto &distance = *queue_distance;
+    for (auto &row : distance) {
+      row.fill(maze::Flood::UNREACHABLE);
+    }
+    std::queue<maze::Position> queue;
+    distance[goal.y][goal.x] = 0;
+    queue.push(goal);
+    while (!queue.empty()) {
+      const auto pos = queue.front();
+      queue.pop();
+      for (int d = 0; d < 4; d++) {
+        const auto dir = static_cast<maze::Direction>(d);
+        const auto next = maze::neighbor(pos, dir);
+        if (maze->is_wall(pos, dir) || !maze->contains(next) ||
+            distance[next.y][next.x] != maze::Flood::UNREACHABLE) {
+          continue;
+        }
+        distance[next.y][next.x] = distance[pos.y][pos.x] + 1;
+        queue.push(next);
+      }
+    }
+  }
+  const auto queue_cycles = (esp_cpu_get_cycle_count() - begin) / ITERATIONS;
+
+  ESP_LOGI(TAG, "Bench: Flood %lu cycles (%d steps), Queue %lu cycles",
+           flood_cycles, flood->steps(), queue_cycles);
+}
+
+// 直進の目標値の1周期あたりのサイクル数を計測する
+void benchmarkStraight() {
+  run::Run run;
+  for (const float length : {90.0f, 1800.0f}) {
+    auto param = run::parameter(*conf, run::Mode::Straight, run::Level::Fast4);
+    param.length = length;
+    param.start_velocity = 0.0f;
+    param.end_velocity = 0.0f;
+    run.reset();
+    uint32_t ticks = 0;
+    uint32_t max_cycles = 0;
+    const auto begin = esp_cpu_get_cycle_count();
+    while (!run.finished() && ticks < 10000) {
+      const auto tick = esp_cpu_get_cycle_count();
+      run.run(param);
+      max_cycles = std::max(max_cycles, esp_cpu_get_cycle_count() - tick);
+      ticks++;
+    }
+    const auto cycles = (esp_cpu_get_cycle_count() - begin) / ticks;
+    ESP_LOGI(TAG,
+             "Bench: Straight %.0f mm, %lu ticks, %lu cycles per tick "
+             "(max %lu)",
+             static_cast<double>(length), ticks, cycles, max_cycles);
+  }
+}
+
+// PID制御の1回の更新あたりのサイクル数を計測する
+void benchmarkPid() {
+  constexpr int UPDATES = 10000;
+  data::Pid<float> pid({conf->velocity_pid[0], conf->velocity_pid[1],
+                        conf->velocity_pid[2]},
+                       0.001f, 0.005f);
+  float u = 0.0f;
+  uint32_t max_cycles = 0;
+  const auto begin = esp_cpu_get_cycle_count();
+  for (int i = 0; i < UPDATES; i++) {
+    const auto tick = esp_cpu_get_cycle_count();
+    u = pid.update(1.0f, u * 0.1f, 0.5f, -4.0f, 4.0f);
+    max_cycles = std::max(max_cycles, esp_cpu_get_cycle_count() - tick);
+  }
+  const auto cycles = (esp_cpu_get_cycle_count() - begin) / UPDATES;
+  ESP_LOGI(TAG, "Bench: Pid %lu cycles per update (max %lu), output %.3f",
+           cycles, max_cycles, static_cast<double>(u));
+}
+
 [[noreturn]] void printSummary() {
   uint64_t index = 0;
 
@@ -109,11 +316,65 @@ void mainTask(void *) {
   }
   conf->write_stdout();
 
+  // 探索中のリセットからは、フラッシュの壁情報を読まずに探索を再開する
+  // (停止した区画に置き直してから、左の車輪を前に回して確定する)
+  if (srch->warm()) {
+    ESP_LOGW(TAG, "Retained search state found. Waiting for confirmation");
+    if (menu->confirm(WARM_CONFIRM_TIMEOUT_MS)) {
+      searchMaze(search::Resume::Warm);
+    }
+  }
+
   dri->buzzer->set(driver::hardware::Buzzer::Mode::InitializeSuccess, false);
   dri->buzzer->update();
 
   // calibrateImu();
-  printSummary();
+  // 起動時のメニュー (インジケータに選んでいる項目の番号を表示する)
+  enum Item : int {
+    Search,   // 記録を消して探索する
+    Journal,  // ストレージの記録を引き継いで探索する
+    Fast,     // ストレージの記録の迷路で最短走行する (続けて走行レベルを選ぶ)
+    Timer,    // 制御周期のばらつき・遅延を計測する
+    Bench,    // 迷路・走行の計算のサイクル数を計測する
+    Summary,  // センサ値を出力し続ける
+    Items,
+  };
+  while (true) {
+    switch (menu->select(Items)) {
+      case Search:
+        searchMaze(search::Resume::None);
+        break;
+      case Journal:
+        searchMaze(search::Resume::Journal);
+        break;
+      case Fast: {
+        const auto item = menu->select(FAST_LEVELS);
+        if (item < 0) {
+          break;
+        }
+        if (!srch->load()) {
+          ESP_LOGW(TAG, "Fast run: no stored maze");
+          break;
+        }
+        const auto level = static_cast<run::Level>(
+            static_cast<int>(run::Level::Fast0) + item);
+        fastRun(srch->maze(), level);
+        break;
+      }
+      case Timer:
+        benchmarkTimer();
+        break;
+      case Bench:
+        benchmarkFlood();
+        benchmarkStraight();
+        benchmarkPid();
+        break;
+      case Summary:
+        printSummary();
+      default:
+        break;
+    }
+  }
 }
 
 // entrypoint
@@ -122,8 +383,10 @@ extern "C" [[maybe_unused]] void app_main(void) {
   dri = new driver::Driver();
   conf = new config::Config();
   odom = new odometry::Odometry(*dri, *conf);
-  mot = new motion::Motion(*dri, *conf, *odom);
-  sens = new sensor::Sensor(*dri, *odom);
+  sens = new sensor::Sensor(*dri, *conf, *odom);
+  mot = new motion::Motion(*dri, *conf, *odom, *sens);
+  srch = new search::Search(*dri, *conf, *odom, *mot);
+  menu = new ui::Ui(*dri, *odom, *sens);
   ESP_LOGI(TAG, "Initializing driver (for pro cpu)");
   dri->init_pro();
   xTaskCreatePinnedToCore(mainTask, "mainTask", 8192 * 2, nullptr, 10, nullptr,
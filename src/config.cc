@@ -52,6 +52,11 @@ bool Config::to_struct(std::string_view str) {
     }
   }
 
+  // 版のない設定ファイルは版0とする
+  version = 0;
+  if (cJSON_GetObjectItemCaseSensitive(json, "version") != nullptr) {
+    JSON_READ_NUMBER(json, version);
+  }
   JSON_READ_NUMBER(json, low_voltage);
   JSON_READ_NUMBER(json, wheel_track_width);
   JSON_READ_NUMBER(json, tire_tread_width);
@@ -66,11 +71,53 @@ bool Config::to_struct(std::string_view str) {
   JSON_READ_NUMBER(json, angular_velocity);
   JSON_READ_NUMBER(json, angular_acceleration);
   JSON_READ_NUMBER(json, angular_jerk);
+  JSON_READ_NUMBER_ARRAY(json, fast_velocity);
+  JSON_READ_NUMBER_ARRAY(json, fast_acceleration);
+  JSON_READ_NUMBER_ARRAY(json, fast_jerk);
+  JSON_READ_NUMBER_ARRAY(json, fast_turn_velocity);
+  JSON_READ_NUMBER_ARRAY(json, fast_angular_velocity);
+  JSON_READ_NUMBER_ARRAY(json, fast_angular_acceleration);
+  JSON_READ_NUMBER_ARRAY(json, fast_angular_jerk);
+  JSON_READ_NUMBER_ARRAY(json, fast_diagonal_velocity);
+  JSON_READ_NUMBER_ARRAY(json, fast_diagonal_acceleration);
+  JSON_READ_NUMBER_ARRAY(json, fast_velocity_pid);
+  JSON_READ_NUMBER_ARRAY(json, fast_angular_velocity_pid);
+  JSON_READ_NUMBER(json, track_distance);
+  JSON_READ_NUMBER(json, track_pose);
+  JSON_READ_NUMBER_ARRAY(json, track_pose_gain);
+  JSON_READ_NUMBER(json, control_frequency);
   JSON_READ_NUMBER_ARRAY(json, maze_goal);
   JSON_READ_NUMBER_ARRAY(json, maze_size);
 
+  migrate();
   return true;
 }
+/**
+ * 版0のPIDゲインは1ms周期の更新ごとの値で、積分は偏差の和に ki を、
+ * kd は前回の偏差を周期で割った値に掛けていた (微分ではない)。
+ * 同じ出力となるよう ki を毎秒の値に換算し、kd の項は kp に含める。
+ * 最短走行のゲインは版0になかったため既定値のままとする。
+ */
+void Config::migrate() {
+  constexpr float LEGACY_PERIOD = 0.001f;
+  if (version > VERSION) {
+    ESP_LOGW(TAG, "Config version %d is newer than %d.", version, VERSION);
+    return;
+  }
+  if (version == VERSION) {
+    return;
+  }
+  for (auto *pid : {&velocity_pid, &angular_velocity_pid}) {
+    auto &[kp, ki, kd] = *pid;
+    ESP_LOGW(TAG, "Rescaling PID gain {%f, %f, %f} from version %d.",
+             static_cast<double>(kp), static_cast<double>(ki),
+             static_cast<double>(kd), version);
+    kp += kd / LEGACY_PERIOD;
+    ki /= LEGACY_PERIOD;
+    kd = 0.0f;
+  }
+  version = VERSION;
+}
 [[maybe_unused]] bool Config::read_file(std::string_view path) {
   std::ifstream file((std::string(path)));
   std::stringstream ss;
@@ -123,6 +170,7 @@ std::string Config::to_str() {
     return "";
   }
 
+  JSON_WRITE_NUMBER(json, version);
   JSON_WRITE_NUMBER(json, low_voltage);
   JSON_WRITE_NUMBER(json, wheel_track_width);
   JSON_WRITE_NUMBER(json, tire_tread_width);
@@ -137,6 +185,21 @@ std::string Config::to_str() {
   JSON_WRITE_NUMBER(json, angular_velocity);
   JSON_WRITE_NUMBER(json, angular_acceleration);
   JSON_WRITE_NUMBER(json, angular_jerk);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_velocity);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_acceleration);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_jerk);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_turn_velocity);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_angular_velocity);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_angular_acceleration);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_angular_jerk);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_diagonal_velocity);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_diagonal_acceleration);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_velocity_pid);
+  JSON_WRITE_NUMBER_ARRAY(json, fast_angular_velocity_pid);
+  JSON_WRITE_NUMBER(json, track_distance);
+  JSON_WRITE_NUMBER(json, track_pose);
+  JSON_WRITE_NUMBER_ARRAY(json, track_pose_gain);
+  JSON_WRITE_NUMBER(json, control_frequency);
   JSON_WRITE_NUMBER_ARRAY(json, maze_goal);
   JSON_WRITE_NUMBER_ARRAY(json, maze_size);
 
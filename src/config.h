@@ -6,6 +6,9 @@
 
 namespace config {
 struct Config {
+  // 設定ファイルの形式の版 (1: PIDゲインを連続時間の値とした)
+  static constexpr int VERSION = 1;
+  int version = VERSION;
   // 停止電圧 [mV]
   int low_voltage = 3500;
   // 車輪間距離 [mm]
@@ -18,15 +21,58 @@ struct Config {
   std::array<int, 4> photo_wall_threshold{0, 0, 0, 0};
   // 壁センサ 迷路中央にいるときの値
   std::array<int, 4> photo_wall_reference{0, 0, 0, 0};
-  // 走行パラメータ
-  std::array<float, 3> velocity_pid{0.0f, 0.0f, 0.0f};
+  // 走行パラメータ (PIDゲインは出力 [V] に対する kp, ki, kd の順)
+  std::array<float, 3> velocity_pid{3.0f, 50.0f, 0.0f};
   float velocity = 0.0f;
   float acceleration = 0.0f;
   float jerk = 0.0f;
-  std::array<float, 3> angular_velocity_pid{0.0f, 0.0f, 0.0f};
+  std::array<float, 3> angular_velocity_pid{0.05f, 1.0f, 0.0f};
   float angular_velocity = 0.0f;
   float angular_acceleration = 0.0f;
   float angular_jerk = 0.0f;
+  // 最短走行パラメータ (Fast0 ~ Fast4)
+  std::array<float, 5> fast_velocity{600.0f, 800.0f, 1000.0f, 1200.0f,
+                                     1500.0f};
+  std::array<float, 5> fast_acceleration{3000.0f, 4000.0f, 5000.0f, 6000.0f,
+                                         8000.0f};
+  std::array<float, 5> fast_jerk{100000.0f, 150000.0f, 200000.0f, 250000.0f,
+                                 300000.0f};
+  std::array<float, 5> fast_turn_velocity{400.0f, 450.0f, 500.0f, 550.0f,
+                                          600.0f};
+  std::array<float, 5> fast_angular_velocity{15.0f, 17.0f, 19.0f, 21.0f,
+                                             23.0f};
+  std::array<float, 5> fast_angular_acceleration{200.0f, 250.0f, 300.0f,
+                                                 350.0f, 400.0f};
+  std::array<float, 5> fast_angular_jerk{10000.0f, 12500.0f, 15000.0f,
+                                         17500.0f, 20000.0f};
+  // 斜め直進の最大速度・最大加速度 (Fast0 ~ Fast4)
+  std::array<float, 5> fast_diagonal_velocity{500.0f, 650.0f, 800.0f, 950.0f,
+                                              1200.0f};
+  std::array<float, 5> fast_diagonal_acceleration{2500.0f, 3500.0f, 4500.0f,
+                                                  5500.0f, 7000.0f};
+  // 速度・角速度のPIDゲイン (Fast0 ~ Fast4 の kp, ki, kd を順に並べる)
+  std::array<float, 15> fast_velocity_pid{
+      3.0f, 50.0f, 0.0f,  // Fast0
+      3.0f, 50.0f, 0.0f,  // Fast1
+      3.0f, 50.0f, 0.0f,  // Fast2
+      3.0f, 50.0f, 0.0f,  // Fast3
+      3.0f, 50.0f, 0.0f,  // Fast4
+  };
+  std::array<float, 15> fast_angular_velocity_pid{
+      0.05f, 1.0f, 0.0f,  // Fast0
+      0.05f, 1.0f, 0.0f,  // Fast1
+      0.05f, 1.0f, 0.0f,  // Fast2
+      0.05f, 1.0f, 0.0f,  // Fast3
+      0.05f, 1.0f, 0.0f,  // Fast4
+  };
+  // 経過時間ではなく測定した距離・角度で目標値を引くか (0: 経過時間)
+  int track_distance = 0;
+  // 姿勢の偏差で速度・角速度の目標値を補正するか (0: 補正しない)
+  int track_pose = 0;
+  // 姿勢の補正のゲイン kx [1/s], ky [1/mm^2], kθ [1/mm]
+  std::array<float, 3> track_pose_gain{20.0f, 0.001f, 0.06f};
+  // センサ取得・速度制御の周波数 [Hz] (1000の倍数、1000 ~ 4000)
+  int control_frequency = 1000;
 
   // 迷路情報
   std::array<int, 2> maze_goal{7, 7};
@@ -40,6 +86,7 @@ struct Config {
 
  private:
   bool to_struct(std::string_view str);
+  void migrate();
   std::string to_str();
 };
 }  // namespace config
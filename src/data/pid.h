@@ -1,70 +1,119 @@
 #pragma once
 
-#include <cmath>
+#include <algorithm>
+#include <limits>
 
 namespace data {
+/**
+ * PID制御 (積分の飽和対策・微分の1次フィルタ付き)
+ *
+ * 制御周期を初期化時に与え、積分・微分の係数を周期に合わせて求めておくため、
+ * ゲインは周期によらない連続時間の値 (出力/偏差, 出力/(偏差·s), 出力·s/偏差)
+ * とし、1回の更新は除算なしの積和と比較のみとなる。
+ * 微分は測定値の変化から求め、kd·s / (tf·s + 1) を後退差分で離散化する。
+ * 目標値の急変で出力が跳ねないよう、偏差ではなく測定値を微分する。
+ * 出力はフィードフォワードを加えた上で範囲内に飽和させ、
+ * 飽和した向きへさらに偏差が積み上がる間は積分を止める (条件付き積分)。
+ * 積分値は出力の単位で保持するため、ゲインを切り替えても出力は連続する。
+ */
+template <typename T = float>
 class Pid {
- private:
+ public:
+  // ゲイン
   struct Gain {
-    struct {
-      bool enable;
-      float value;
-    } kp, ki, kd;
-  } gain_{};
+    T kp;
+    T ki;
+    T kd;
+  };
 
-  float prev_target_{};
-  float prev_{};
+ private:
+  //! 制御周期 [s]
+  T period_;
+  //! 微分の1次フィルタの時定数 [s]
+  T filter_;
+  //! ゲイン
+  Gain gain_{};
+  //! 周期ごとの積分・微分の係数と微分の前回値の割合
+  T ki_period_{};
+  T kd_period_{};
+  T decay_{};
 
-  float sum_target_{};
-  float sum_{};
+  //! 積分値 (出力の単位)
+  T integral_{};
+  //! フィルタ後の微分値 (出力の単位)
+  T derivative_{};
+  //! 前回の測定値
+  T prev_{};
+  //! 前回の測定値があるか
+  bool primed_{false};
 
  public:
-  explicit Pid(float kp, float ki, float kd) {
-    gain_.kp.enable = true;
-    gain_.ki.enable = true;
-    gain_.kd.enable = true;
-
-    gain_.kp.value = kp;
-    gain_.ki.value = ki;
-    gain_.kd.value = kd;
+  /**
+   * @param gain ゲイン
+   * @param period 制御周期 [s]
+   * @param filter 微分の1次フィルタの時定数 [s] (0ならフィルタなし)
+   */
+  explicit Pid(const Gain &gain, T period, T filter = T{})
+      : period_(period), filter_(filter) {
+    this->gain(gain);
     reset();
   }
-  Gain &gain() { return gain_; }
+  ~Pid() = default;
 
-  void reset() {
-    prev_target_ = 0.0f;
-    prev_ = 0.0f;
-    sum_target_ = 0.0f;
-    sum_ = 0.0f;
+  /**
+   * @brief ゲインを変更する (積分値・微分値は引き継ぐ)
+   */
+  void gain(const Gain &gain) {
+    gain_ = gain;
+    ki_period_ = gain_.ki * period_;
+    kd_period_ = gain_.kd / (filter_ + period_);
+    decay_ = filter_ / (filter_ + period_);
   }
+  [[nodiscard]] const Gain &gain() const { return gain_; }
 
-  float update(float target, float current, float dt) {
-    float ret = 0.0f;
-
-    if (gain_.kp.enable) {
-      ret += gain_.kp.value * (target - current);
-    }
-    if (gain_.ki.enable) {
-      ret += gain_.ki.value * (sum_target_ - sum_);
-    }
-    if (gain_.kd.enable) {
-      ret += gain_.kd.value * (prev_target_ - prev_) / dt;
-    }
-
-    if ((!std::signbit(target) && (sum_target_ + target) > sum_target_) ||
-        (std::signbit(target) && (sum_target_ + target) < sum_target_)) {
-      sum_target_ += target;
-    }
+  /**
+   * @brief 制御周期を変更する (積分値・微分値は引き継ぐ)
+   */
+  void period(T period) {
+    period_ = period;
+    gain(gain_);
+  }
+  [[nodiscard]] T period() const { return period_; }
 
-    if ((!std::signbit(current) && (sum_ + current) > sum_) ||
-        (std::signbit(current) && (sum_ + current) < sum_)) {
-      sum_ += current;
-    }
+  void reset() {
+    integral_ = T{};
+    derivative_ = T{};
+    prev_ = T{};
+    primed_ = false;
+  }
 
-    prev_target_ = target;
+  /**
+   * @brief 1周期分更新する
+   * @param target 目標値
+   * @param current 測定値
+   * @param feedforward 出力に加えるフィードフォワード
+   * @param min, max 出力の範囲
+   * @return フィードフォワードを含めて飽和させた出力
+   */
+  T update(T target, T current, T feedforward = T{},
+           T min = std::numeric_limits<T>::lowest(),
+           T max = std::numeric_limits<T>::max()) {
+    const auto error = target - current;
+    const auto delta = primed_ ? current - prev_ : T{};
+    derivative_ = decay_ * derivative_ - kd_period_ * delta;
     prev_ = current;
+    primed_ = true;
 
-    return ret;
+    const auto output =
+        feedforward + gain_.kp * error + integral_ + derivative_;
+    // 飽和した向きへ偏差が積み上がる間は積分しない
+    if (!(output > max && error > T{}) && !(output < min && error < T{})) {
+      integral_ += ki_period_ * error;
+    }
+    return std::clamp(output, min, max);
   }
+
+  /// 積分値 (出力の単位)
+  [[nodiscard]] T integral() const { return integral_; }
 };
-}  // namespace data
\ No newline at end of file
+}  // namespace data
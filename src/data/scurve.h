@@ -0,0 +1,225 @@
+#pragma once
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace data {
+/**
+ * 躍度制限付きのS字加減速 (7区間)
+ *
+ * 開始速度から到達速度まで加速(躍度+, 加速度一定, 躍度-)し、
+ * 到達速度で等速走行した後、終了速度まで減速(躍度-, 加速度一定, 躍度+)する。
+ * 区間の境界での状態を初期化時に求めておき、
+ * 経過時間からの状態は該当区間の3次式で直接求めるため、
+ * 1回の評価の計算量は一定で、積分による誤差の蓄積もない。
+ * 距離が足りず終了速度まで加減速しきれない場合は終了速度を変更し
+ * (加速しきれなければ下げ、減速しきれなければ上げる)、feasible() で知らせる。
+ */
+class SCurve {
+ public:
+  // 時刻tでの状態
+  struct State {
+    float jerk;
+    float acceleration;
+    float velocity;
+    float position;
+  };
+
+ private:
+  static constexpr std::size_t PHASES = 7;
+
+  // 区間
+  struct Phase {
+    // 開始時刻
+    float time;
+    // 躍度
+    float jerk;
+    // 開始時の状態
+    float acceleration;
+    float velocity;
+    float position;
+  };
+  std::array<Phase, PHASES> phases_{};
+  // 全体の時間
+  float duration_{0.0f};
+  // 到達速度・終了速度
+  float peak_velocity_{0.0f};
+  float end_velocity_{0.0f};
+  // 距離
+  float length_{0.0f};
+  // 指定の終了速度のまま加減速できたか
+  bool feasible_{true};
+
+  float max_acceleration_{1.0f};
+  float max_jerk_{1.0f};
+
+  // 速度をfromからtoに変える区間の躍度一定・加速度一定の時間
+  void transition(float from, float to, float &jerk_time,
+                  float &constant_time) const {
+    const auto dv = std::abs(to - from);
+    const auto a = max_acceleration_;
+    const auto j = max_jerk_;
+    if (dv * j >= a * a) {
+      jerk_time = a / j;
+      constant_time = dv / a - a / j;
+    } else {
+      jerk_time = std::sqrt(dv / j);
+      constant_time = 0.0f;
+    }
+  }
+  // 速度をfromからtoに変える距離
+  float transition_distance(float from, float to) const {
+    float tj, ta;
+    transition(from, to, tj, ta);
+    return (from + to) / 2.0f * (2.0f * tj + ta);
+  }
+  // 到達速度をpeakとしたときの加減速の距離
+  float distance(float v0, float peak, float v1) const {
+    return transition_distance(v0, peak) + transition_distance(peak, v1);
+  }
+  // 距離がlengthとなる速度を[low, high]から二分探索する
+  template <typename F>
+  static float bisect(float low, float high, float length, F &&f) {
+    for (int i = 0; i < 20; i++) {
+      const auto mid = (low + high) / 2.0f;
+      if (f(mid) <= length) {
+        low = mid;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  // 区間を追加する
+  void push(std::size_t &n, float duration, float jerk) {
+    auto &p = phases_[n];
+    if (n + 1 < PHASES) {
+      auto &q = phases_[n + 1];
+      const auto t = duration;
+      q.time = p.time + t;
+      q.jerk = 0.0f;
+      q.acceleration = p.acceleration + jerk * t;
+      q.velocity = p.velocity + p.acceleration * t + jerk * t * t / 2.0f;
+      q.position = p.position + p.velocity * t +
+                   p.acceleration * t * t / 2.0f + jerk * t * t * t / 6.0f;
+    }
+    p.jerk = jerk;
+    n++;
+  }
+
+ public:
+  explicit SCurve() = default;
+  ~SCurve() = default;
+
+  /**
+   * @brief 加減速の区間を求める
+   * @param length 距離
+   * @param v0 開始速度
+   * @param v1 終了速度
+   * @param max_velocity 最大速度
+   * @param max_acceleration 最大加速度
+   * @param max_jerk 最大躍度
+   */
+  void reset(float length, float v0, float v1, float max_velocity,
+             float max_acceleration, float max_jerk) {
+    length_ = std::max(length, 0.0f);
+    max_acceleration_ = std::max(max_acceleration, 1e-3f);
+    max_jerk_ = std::max(max_jerk, 1e-3f);
+    v0 = std::max(v0, 0.0f);
+    v1 = std::max(v1, 0.0f);
+
+    // 到達速度を求める
+    auto peak = std::max(max_velocity, std::max(v0, v1));
+    feasible_ = distance(v0, std::max(v0, v1), v1) <= length_;
+    if (!feasible_) {
+      // 終了速度まで加減速しきれない
+      if (v1 > v0) {
+        v1 = bisect(v0, v1, length_,
+                    [&](float v) { return transition_distance(v0, v); });
+      } else {
+        // 減速の距離は終了速度が高いほど短い
+        v1 = bisect(v1, v0, -length_,
+                    [&](float v) { return -transition_distance(v0, v); });
+      }
+      peak = std::max(v0, v1);
+    } else if (distance(v0, peak, v1) > length_) {
+      // 加速・減速とも加速度一定の区間がある場合は2次方程式の解
+      const auto a = max_acceleration_;
+      const auto j = max_jerk_;
+      const auto c = -(v0 * v0 + v1 * v1) / (2.0f * a) +
+                     (v0 + v1) * a / (2.0f * j) - length_;
+      const auto b = a / j;
+      const auto closed = (-b + std::sqrt(b * b - 4.0f * c / a)) * a / 2.0f;
+      const auto threshold = a * a / j;
+      if (closed - v0 >= threshold && closed - v1 >= threshold) {
+        peak = closed;
+      } else {
+        peak = bisect(std::max(v0, v1), peak, length_,
+                      [&](float v) { return distance(v0, v, v1); });
+      }
+    }
+    peak_velocity_ = peak;
+    end_velocity_ = v1;
+
+    // 区間の境界での状態を求める
+    float tj0, ta0, tj1, ta1;
+    transition(v0, peak, tj0, ta0);
+    transition(peak, v1, tj1, ta1);
+    const auto j = max_jerk_;
+    const auto s0 = peak >= v0 ? 1.0f : -1.0f;
+    const auto s1 = v1 >= peak ? 1.0f : -1.0f;
+    const auto cruise = std::max(
+        (length_ - distance(v0, peak, v1)) / std::max(peak, 1e-3f), 0.0f);
+
+    phases_[0] = {0.0f, 0.0f, 0.0f, v0, 0.0f};
+    std::size_t n = 0;
+    push(n, tj0, s0 * j);
+    push(n, ta0, 0.0f);
+    push(n, tj0, -s0 * j);
+    push(n, cruise, 0.0f);
+    push(n, tj1, s1 * j);
+    push(n, ta1, 0.0f);
+    push(n, tj1, -s1 * j);
+    duration_ = phases_[PHASES - 1].time + tj1;
+  }
+
+  /**
+   * @brief 時刻tでの状態 (区間外は開始時・終了時の状態)
+   */
+  State at(float t) const {
+    if (t <= 0.0f) {
+      const auto &p = phases_[0];
+      return {0.0f, 0.0f, p.velocity, 0.0f};
+    }
+    if (t >= duration_) {
+      return {0.0f, 0.0f, end_velocity_, length_};
+    }
+    std::size_t i = PHASES - 1;
+    while (i > 0 && phases_[i].time > t) {
+      i--;
+    }
+    const auto &p = phases_[i];
+    const auto tau = t - p.time;
+    return {
+        p.jerk,
+        p.acceleration + p.jerk * tau,
+        p.velocity + p.acceleration * tau + p.jerk * tau * tau / 2.0f,
+        p.position + p.velocity * tau + p.acceleration * tau * tau / 2.0f +
+            p.jerk * tau * tau * tau / 6.0f,
+    };
+  }
+
+  /// 全体の時間
+  float duration() const { return duration_; }
+  /// 到達速度
+  float peak_velocity() const { return peak_velocity_; }
+  /// 終了速度 (距離が足りない場合は指定と異なる)
+  float end_velocity() const { return end_velocity_; }
+  /// 指定の終了速度のまま加減速できたか
+  bool feasible() const { return feasible_; }
+};
+}  // namespace data
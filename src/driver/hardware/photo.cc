@@ -156,8 +156,10 @@ class Photo::PhotoImpl final : public DriverBase {
            flash_start_err == ESP_OK;
   }
 
-  bool wait() {
-    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+  bool wait(TickType_t ticks_to_wait) {
+    if (ulTaskNotifyTake(pdFALSE, ticks_to_wait) == 0) {
+      return false;
+    }
     esp_err_t receive_disable_err = gptimer_disable(receive_timer_);
     esp_err_t flash_disable_err = gptimer_disable(flash_timer_);
     return receive_disable_err == ESP_OK && flash_disable_err == ESP_OK;
@@ -173,7 +175,9 @@ Photo::Photo(Config &config) : impl_(new PhotoImpl(config)) {}
 Photo::~Photo() = default;
 
 bool Photo::update() { return impl_->update(); }
-bool Photo::wait() { return impl_->wait(); }
+bool Photo::wait(TickType_t ticks_to_wait) {
+  return impl_->wait(ticks_to_wait);
+}
 
 const Photo::Result &Photo::left90() { return impl_->left90(); }
 const Photo::Result &Photo::left45() { return impl_->left45(); }
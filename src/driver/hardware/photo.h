@@ -5,6 +5,7 @@
 #include <memory>
 
 // ESP-IDF
+#include <freertos/FreeRTOS.h>
 #include <hal/adc_types.h>
 #include <hal/gpio_types.h>
 
@@ -35,7 +36,12 @@ class Photo final : public DriverBase {
   ~Photo();
 
   bool update() override;
-  bool wait();
+  /**
+   * @brief 全てのセンサの取得の完了を待つ
+   * @param ticks_to_wait 待つ最大のティック数 (0なら完了を確認するだけ)
+   * @return 完了したか (完了していなければタイマを動かしたまま戻る)
+   */
+  bool wait(TickType_t ticks_to_wait = portMAX_DELAY);
 
   const Result &left90();
   const Result &left45();
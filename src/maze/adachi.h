@@ -0,0 +1,268 @@
+#pragma once
+
+// C++
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+
+// Project
+#include "candidates.h"
+#include "flood.h"
+#include "incremental.h"
+#include "maze.h"
+
+namespace maze {
+// 進行方向に対する旋回
+enum class Turn : int8_t { Left = -1, Straight = 0, Right = 1, Back = 2 };
+
+// 探索の段階
+enum class Phase : uint8_t {
+  Goal,      // ゴールへ向かう
+  Explore,   // 最短経路を短縮し得る区画を経由してスタートへ戻る
+  Return,    // スタートへ戻る
+  Finished,  // スタート区画に戻った
+};
+
+/**
+ * @brief 足立法による探索の判断
+ * @details
+ * 次に進入する区画の壁情報を受け取って迷路を更新し、
+ * ゴールからの歩数が最小となる隣接区画へ向かう旋回を決める。
+ * 未観測の壁は壁がないものとして歩数を求める。
+ * ゴール・スタートへ向かう間は目標区画が変わらないため、歩数マップを
+ * 壁の変化に合わせて Incremental で差分更新する。
+ * 経由する候補は区画ごとに変わり得るため、候補へ向かう間は
+ * 候補からの歩数マップを Flood で毎回作り直す。
+ * ゴール到達後は Candidates で最短経路が確定したかを判定し、
+ * 確定するまで最短経路を短縮し得る区画を経由しながらスタートへ戻る。
+ * 経由する区画は、現在地からの歩数とスタートまでの歩数の和が最小の候補とし、
+ * 帰路から外れた候補は後回しにする。
+ * 確定した時点で残りの候補は探索せず、まっすぐスタートへ戻る。
+ * 走行とは独立しているため、実機の探索とシミュレーションで共用する。
+ */
+class Adachi {
+ public:
+  /// スタート区画
+  static constexpr Position START{0, 0};
+
+ private:
+  //! 迷路
+  Maze maze_;
+  //! ゴール・スタートからの歩数マップ (壁の変化で差分更新する)
+  Incremental distance_;
+  //! 経由する候補からの歩数マップ (区画ごとに作り直す)
+  Flood waypoint_;
+  //! 最短経路の確定判定
+  Candidates candidates_;
+  //! ゴール区画
+  Position goal_;
+  //! 探索の段階
+  Phase phase_{Phase::Goal};
+  //! distance_ の目標区画 (候補へ向かう間は更新しないため空とする)
+  Flood::Rows targets_{};
+  //! 現在地からの歩数マップ
+  Flood reach_;
+  //! 次に進入する区画
+  Position pos_{0, 1};
+  //! 進行方向
+  Direction dir_{Direction::North};
+
+  /**
+   * @brief スタート区画から北の区画へ進入する状態にする
+   */
+  void restart() {
+    phase_ = Phase::Goal;
+    targets_ = Flood::cells({goal_});
+    distance_.reset(maze_, targets_);
+    pos_ = {0, 1};
+    dir_ = Direction::North;
+  }
+
+  /**
+   * @brief 帰路で経由する探索候補を選ぶ
+   * @details
+   * 現在地からの歩数とスタートまでの歩数の和が最小の候補を選ぶ。
+   * 和が等しい場合は現在地に近い候補を優先する。
+   */
+  Position waypoint() {
+    reach_.update(maze_, Flood::cells({pos_}), Flood::Unknown::Open);
+    Position ret = START;
+    auto min_cost = Flood::UNREACHABLE;
+    auto min_reach = Flood::UNREACHABLE;
+    const auto &cells = candidates_.cells();
+    for (int y = 0; y < maze_.height(); y++) {
+      for (auto bits = cells[y]; bits != 0; bits &= bits - 1) {
+        const Position pos{static_cast<int8_t>(std::countr_zero(bits)),
+                           static_cast<int8_t>(y)};
+        const auto reach = reach_.distance(pos);
+        const auto home = candidates_.from_start(pos);
+        if (reach == Flood::UNREACHABLE || home == Flood::UNREACHABLE) {
+          continue;
+        }
+        const auto cost = reach + home;
+        if (cost < min_cost || (cost == min_cost && reach < min_reach)) {
+          min_cost = cost;
+          min_reach = reach;
+          ret = pos;
+        }
+      }
+    }
+    return ret;
+  }
+
+ public:
+  explicit Adachi(const std::array<int, 2> &size, Position goal)
+      : maze_(size), goal_(goal) {
+    reset();
+  }
+  ~Adachi() = default;
+
+  /**
+   * @brief 迷路を初期化し、スタート区画から北の区画へ進入する状態にする
+   */
+  void reset() {
+    maze_.reset();
+    restart();
+  }
+
+  /**
+   * @brief 記録済みの迷路を引き継ぎ、スタート区画から探索をやり直す
+   */
+  void resume(const Maze &maze) {
+    maze_ = maze;
+    restart();
+  }
+
+  /**
+   * @brief 目標区画を変更する (変化した場合のみ歩数マップを再計算する)
+   */
+  void retarget(const Flood::Rows &targets) {
+    if (targets == targets_) {
+      return;
+    }
+    targets_ = targets;
+    distance_.reset(maze_, targets_);
+  }
+
+  /**
+   * @brief 経由する候補からの歩数マップを作り直す
+   * @details
+   * 候補へ向かう間は distance_ を差分更新しないため、
+   * 次にゴール・スタートへ向かうときは作り直すよう目標区画を空にする。
+   */
+  void detour(Position waypoint) {
+    targets_.fill(0);
+    waypoint_.update(maze_, Flood::cells({waypoint}), Flood::Unknown::Open);
+  }
+
+  /**
+   * @brief 次に進入する区画の壁を更新する
+   * @param front 進行方向から見た前の壁
+   * @param left 進行方向から見た左の壁
+   * @param right 進行方向から見た右の壁
+   */
+  void update(bool front, bool left, bool right) {
+    // 候補へ向かう間は歩数マップを transition() で作り直す
+    const bool incremental = phase_ != Phase::Explore;
+    auto set = [&](Direction dir, bool exists) {
+      if (maze_.set_wall(pos_, dir, exists) && incremental) {
+        distance_.invalidate(maze_, pos_, dir);
+      }
+    };
+    // 進入してきた方向には壁がない
+    set(rotate(dir_, 2), false);
+    set(dir_, front);
+    set(rotate(dir_, -1), left);
+    set(rotate(dir_, 1), right);
+    if (incremental) {
+      distance_.repair(maze_);
+    }
+    transition();
+  }
+
+  /**
+   * @brief 探索の途中の状態を復元する
+   * @param pos 次に進入する区画
+   * @param dir 進行方向
+   */
+  void restore(const Maze &maze, Phase phase, Position pos, Direction dir) {
+    maze_ = maze;
+    phase_ = phase;
+    pos_ = pos;
+    dir_ = dir;
+    targets_.fill(0);
+    if (phase_ == Phase::Explore) {
+      candidates_.update(maze_, START, goal_);
+      detour(waypoint());
+    } else {
+      retarget(Flood::cells({phase_ == Phase::Goal ? goal_ : START}));
+    }
+  }
+
+ private:
+  /**
+   * @brief 進入する区画の壁を更新した後、探索の段階と目標区画を更新する
+   */
+  void transition() {
+    if (phase_ == Phase::Goal && pos_ == goal_) {
+      phase_ = Phase::Explore;
+    }
+    if (phase_ == Phase::Explore) {
+      candidates_.update(maze_, START, goal_);
+      if (candidates_.proven() || candidates_.empty()) {
+        phase_ = Phase::Return;
+        retarget(Flood::cells({START}));
+      } else {
+        detour(waypoint());
+      }
+    }
+    if (phase_ == Phase::Return && pos_ == START) {
+      phase_ = Phase::Finished;
+    }
+  }
+
+ public:
+  /**
+   * @brief 歩数が最小となる方向を選ぶ (同じ歩数なら直進・左・右・後退の順)
+   * @return 目標区画への経路がなければnullopt
+   */
+  [[nodiscard]] std::optional<Turn> next() const {
+    static constexpr Turn PRIORITY[] = {Turn::Straight, Turn::Left,
+                                        Turn::Right, Turn::Back};
+    std::optional<Turn> ret;
+    auto min = Flood::UNREACHABLE;
+    for (auto turn : PRIORITY) {
+      const auto dir = rotate(dir_, static_cast<int>(turn));
+      const auto next = neighbor(pos_, dir);
+      if (maze_.is_wall(pos_, dir) || !maze_.contains(next)) {
+        continue;
+      }
+      const auto d = phase_ == Phase::Explore ? waypoint_.distance(next)
+                                              : distance_.distance(next);
+      if (d < min) {
+        min = d;
+        ret = turn;
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * @brief 旋回して次の区画へ進む
+   */
+  void advance(Turn turn) {
+    dir_ = rotate(dir_, static_cast<int>(turn));
+    pos_ = neighbor(pos_, dir_);
+  }
+
+  [[nodiscard]] bool is_goal() const { return pos_ == goal_; }
+  [[nodiscard]] bool finished() const { return phase_ == Phase::Finished; }
+  [[nodiscard]] Phase phase() const { return phase_; }
+  [[nodiscard]] const Candidates &candidates() const { return candidates_; }
+  [[nodiscard]] Position position() const { return pos_; }
+  [[nodiscard]] Direction direction() const { return dir_; }
+  [[nodiscard]] Position goal() const { return goal_; }
+  [[nodiscard]] const Maze &maze() const { return maze_; }
+};
+}  // namespace maze
@@ -0,0 +1,46 @@
+#include "candidates.h"
+
+// C++
+#include <bit>
+
+namespace maze {
+Maze::Row Candidates::visited(const Maze &maze, int y) {
+  const auto mask = maze.row_mask();
+  // 南端・西端の外壁は観測済み
+  const auto south = y == 0 ? mask : maze.north_observed(y - 1);
+  const auto west = (maze.east_observed(y) << 1) | Maze::Row{1};
+  return maze.north_observed(y) & south & maze.east_observed(y) & west & mask;
+}
+
+void Candidates::update(const Maze &maze, Position start, Position goal) {
+  start_.update(maze, Flood::cells({start}), Flood::Unknown::Open);
+  goal_.update(maze, Flood::cells({goal}), Flood::Unknown::Open);
+  known_.update(maze, Flood::cells({goal}), Flood::Unknown::Wall);
+  optimistic_length_ = goal_.distance(start);
+  known_length_ = known_.distance(start);
+
+  cells_.fill(0);
+  if (proven()) {
+    return;
+  }
+  for (int y = 0; y < maze.height(); y++) {
+    for (auto bits = ~visited(maze, y) & maze.row_mask(); bits != 0;
+         bits &= bits - 1) {
+      const auto x = std::countr_zero(bits);
+      const Position pos{static_cast<int8_t>(x), static_cast<int8_t>(y)};
+      const auto s = start_.distance(pos);
+      const auto g = goal_.distance(pos);
+      if (s == Flood::UNREACHABLE || g == Flood::UNREACHABLE) {
+        continue;
+      }
+      // 既知の経路がない間は楽観的な最短経路上の区画のみ
+      const auto bound = known_length_ == Flood::UNREACHABLE
+                             ? optimistic_length_ + 1
+                             : known_length_;
+      if (s + g < bound) {
+        cells_[y] |= Maze::Row{1} << x;
+      }
+    }
+  }
+}
+}  // namespace maze
@@ -0,0 +1,77 @@
+#pragma once
+
+// C++
+#include <cstdint>
+
+// Project
+#include "flood.h"
+#include "maze.h"
+
+namespace maze {
+/**
+ * @brief 最短経路の確定判定と、最短経路を短縮し得る未訪問区画の抽出
+ * @details
+ * 未観測の壁をないものとした楽観的な歩数と、
+ * 未観測の壁をあるものとした既知の壁のみの歩数を比べる。
+ * スタートからゴールまでの両者が一致すれば最短経路は確定している。
+ * 一致しない間は、スタート・ゴール双方からの楽観的な歩数の和が
+ * 既知の最短歩数より小さい未訪問区画のみを探索候補とする。
+ */
+class Candidates {
+ public:
+  using Rows = Flood::Rows;
+  using Distance = Flood::Distance;
+
+ private:
+  //! スタートからの楽観的な歩数
+  Flood start_;
+  //! ゴールからの楽観的な歩数
+  Flood goal_;
+  //! ゴールからの既知の壁のみの歩数
+  Flood known_;
+  //! 探索候補の区画
+  Rows cells_{};
+  //! スタートからゴールまでの楽観的な歩数・既知の壁のみの歩数
+  Distance optimistic_length_{Flood::UNREACHABLE};
+  Distance known_length_{Flood::UNREACHABLE};
+
+ public:
+  explicit Candidates() = default;
+  ~Candidates() = default;
+
+  /**
+   * @brief 四方の壁を全て観測済みの区画の行マスク
+   */
+  static Maze::Row visited(const Maze &maze, int y);
+
+  /**
+   * @brief 歩数と探索候補を更新する
+   */
+  void update(const Maze &maze, Position start, Position goal);
+
+  /// 最短経路が確定しているか
+  [[nodiscard]] bool proven() const {
+    return known_length_ != Flood::UNREACHABLE &&
+           optimistic_length_ == known_length_;
+  }
+  /// 探索候補がないか
+  [[nodiscard]] bool empty() const {
+    for (auto row : cells_) {
+      if (row != 0) return false;
+    }
+    return true;
+  }
+  /// 探索候補の区画
+  [[nodiscard]] const Rows &cells() const { return cells_; }
+  /// スタートからの楽観的な歩数
+  [[nodiscard]] Distance from_start(Position pos) const {
+    return start_.distance(pos);
+  }
+  /// スタートからゴールまでの楽観的な歩数
+  [[nodiscard]] Distance optimistic_length() const {
+    return optimistic_length_;
+  }
+  /// スタートからゴールまでの既知の壁のみの歩数
+  [[nodiscard]] Distance known_length() const { return known_length_; }
+};
+}  // namespace maze
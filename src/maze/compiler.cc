@@ -0,0 +1,319 @@
+#include "compiler.h"
+
+// C++
+#include <algorithm>
+#include <memory>
+
+// Project
+#include "data/scurve.h"
+#include "flood.h"
+#include "planner.h"
+#include "slalom.h"
+
+namespace maze {
+namespace {
+//! 直進・斜め直進の1単位の距離 [mm]
+constexpr float STRAIGHT_UNIT = CELL_SIZE;
+constexpr float DIAGONAL_UNIT = run::DIAGONAL_UNIT;
+
+// 区画での旋回
+enum class Step : uint8_t { Straight, Right, Left, End };
+
+// 旋回の向きに応じた走行モード
+constexpr run::Mode turn(Step step, run::Mode right, run::Mode left) {
+  return step == Step::Right ? right : left;
+}
+
+// 直進・斜め直進の区間か
+bool is_straight(const run::Parameter &param) {
+  return param.mode == run::Mode::Straight ||
+         param.mode == run::Mode::Diagonal;
+}
+
+// 距離lengthで速度vから加速して到達できる速度
+// (S字加減速は加速と減速が対称なため、減速して速度vとなる開始速度の上限)
+float reachable(float length, float v, const run::Parameter &param) {
+  data::SCurve curve;
+  curve.reset(length, v, param.max_velocity, param.max_velocity,
+              param.max_acceleration, param.max_jerk);
+  return curve.end_velocity();
+}
+
+// 隣接する区画への方角
+bool direction(Position from, Position to, Direction &dir) {
+  for (int i = 0; i < 4; i++) {
+    dir = static_cast<Direction>(i);
+    if (neighbor(from, dir) == to) return true;
+  }
+  return false;
+}
+}  // namespace
+
+Compiler::Path Compiler::path(const Maze &maze, Position goal) {
+  return path(maze, {0, 0}, Direction::North, goal);
+}
+
+Compiler::Path Compiler::path(const Maze &maze, Position from, Direction dir,
+                              Position goal) {
+  auto flood = std::make_unique<Flood>();
+  flood->update(maze, Flood::cells({goal}), Flood::Unknown::Wall);
+  Path path;
+  Position pos = from;
+  if (flood->distance(pos) == Flood::UNREACHABLE) {
+    return path;
+  }
+  path.push_back(pos);
+  while (!(pos == goal)) {
+    // 直進・右・左・後退の順に、歩数が1少ない区画を探す
+    bool found = false;
+    for (int turn : {0, 1, 3, 2}) {
+      const auto next_dir = rotate(dir, turn);
+      const auto next = neighbor(pos, next_dir);
+      if (maze.is_wall(pos, next_dir) || !maze.is_observed(pos, next_dir) ||
+          !maze.contains(next) ||
+          flood->distance(next) + 1 != flood->distance(pos)) {
+        continue;
+      }
+      dir = next_dir;
+      pos = next;
+      found = true;
+      break;
+    }
+    if (!found) {
+      return {};
+    }
+    path.push_back(pos);
+  }
+  return path;
+}
+
+void Compiler::push_straight(run::Mode mode, float length,
+                             run::Level level) {
+  // 直前の旋回で短縮した分を差し引く
+  length += carry_;
+  carry_ = 0.0f;
+  if (length <= 0.0f) {
+    return;
+  }
+  auto param = run::parameter(conf_, mode, level);
+  param.length = length;
+  param.angle = 0.0f;
+  route_.push_back(param);
+}
+
+void Compiler::push_turn(run::Mode mode, run::Level level, bool diagonal) {
+  const auto profile = slalom::profile(mode, diagonal);
+  // 曲線区間の前後の直進が負の場合は隣の直進を短縮する
+  if (profile.before < 0.0f && !route_.empty()) {
+    auto &prev = route_.back();
+    if (prev.mode == run::Mode::Straight || prev.mode == run::Mode::Diagonal) {
+      prev.length = std::max(prev.length + profile.before, 0.0f);
+    }
+  }
+  carry_ = std::min(profile.after, 0.0f);
+  auto param = run::parameter(conf_, mode, level);
+  param.max_velocity = slalom::velocity(profile, param);
+  param.length = profile.travel();
+  param.angle = profile.angle;
+  route_.push_back(param);
+}
+
+void Compiler::plan_velocities() {
+  // 区間の境界の速度を上限から始め、前向き・後ろ向きに下げる
+  const auto n = route_.size();
+  velocities_.assign(n + 1, 0.0f);
+  for (std::size_t i = 1; i < n; i++) {
+    velocities_[i] =
+        std::min(route_[i - 1].max_velocity, route_[i].max_velocity);
+  }
+  // 前向き: 直進は加速して到達できる速度、旋回は等速
+  for (std::size_t i = 0; i < n; i++) {
+    const auto &param = route_[i];
+    const auto v = is_straight(param)
+                       ? reachable(param.length, velocities_[i], param)
+                       : velocities_[i];
+    velocities_[i + 1] = std::min(velocities_[i + 1], v);
+  }
+  // 後ろ向き: 直進は次の区間の開始速度まで減速できる速度、旋回は等速
+  for (std::size_t i = n; i-- > 0;) {
+    const auto &param = route_[i];
+    const auto v = is_straight(param)
+                       ? reachable(param.length, velocities_[i + 1], param)
+                       : velocities_[i + 1];
+    velocities_[i] = std::min(velocities_[i], v);
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    route_[i].start_velocity = velocities_[i];
+    route_[i].end_velocity =
+        is_straight(route_[i]) ? velocities_[i + 1] : velocities_[i];
+  }
+}
+
+void Compiler::select_levels(run::Level level) {
+  // 走行時間が変わらなければ加速度の小さい低い走行レベルを選ぶ
+  for (auto &param : route_) {
+    if (!is_straight(param)) {
+      continue;
+    }
+    const auto v0 = param.start_velocity;
+    const auto v1 = param.end_velocity;
+    const auto fastest = Planner::travel_time(param.length, v0, v1, param);
+    for (auto l = static_cast<int>(run::Level::Fast0);
+         l < static_cast<int>(level); l++) {
+      auto lower =
+          run::parameter(conf_, param.mode, static_cast<run::Level>(l));
+      // 計画した境界の速度を加減速できないレベルは選ばない
+      if (lower.max_velocity < std::max(v0, v1) ||
+          reachable(param.length, std::min(v0, v1), lower) <
+              std::max(v0, v1)) {
+        continue;
+      }
+      if (Planner::travel_time(param.length, v0, v1, lower) <=
+          fastest * (1.0f + TIME_MARGIN)) {
+        lower.length = param.length;
+        lower.angle = param.angle;
+        lower.start_velocity = v0;
+        lower.end_velocity = v1;
+        param = lower;
+        break;
+      }
+    }
+  }
+}
+
+bool Compiler::compile(const Path &path, run::Level level) {
+  route_.clear();
+  time_ = 0.0f;
+  carry_ = 0.0f;
+  if (path.size() < 2 || !(path.front() == Position{0, 0})) {
+    return false;
+  }
+
+  // 区画ごとの旋回の列に変換する (先頭はスタート区画から進入する区画)
+  std::vector<Step> steps;
+  Direction dir;
+  if (!direction(path[0], path[1], dir) || dir != Direction::North) {
+    return false;
+  }
+  for (std::size_t i = 1; i + 1 < path.size(); i++) {
+    Direction next;
+    if (!direction(path[i], path[i + 1], next)) {
+      return false;
+    }
+    const auto diff = (static_cast<int>(next) - static_cast<int>(dir)) & 0x03;
+    if (diff == 2) {
+      return false;
+    }
+    steps.push_back(diff == 0   ? Step::Straight
+                    : diff == 1 ? Step::Right
+                                : Step::Left);
+    dir = next;
+  }
+  steps.push_back(Step::End);
+  auto at = [&](std::size_t i) {
+    return i < steps.size() ? steps[i] : Step::End;
+  };
+  auto is_turn = [](Step step) {
+    return step == Step::Right || step == Step::Left;
+  };
+
+  // スタート区画中央から区画境界まで
+  float straight = STRAIGHT_UNIT / 2.0f;
+  int diagonal = 0;
+  bool orthogonal = true;
+  for (std::size_t i = 0; i < steps.size();) {
+    const auto s0 = at(i);
+    const auto s1 = at(i + 1);
+    const auto s2 = at(i + 2);
+    if (s0 == Step::End) {
+      // ゴール区画中央で停止
+      push_straight(run::Mode::Straight, straight + STRAIGHT_UNIT / 2.0f,
+                    level);
+      break;
+    }
+    if (orthogonal) {
+      if (s0 == Step::Straight) {
+        straight += STRAIGHT_UNIT;
+        i++;
+        continue;
+      }
+      push_straight(run::Mode::Straight, straight, level);
+      straight = 0.0f;
+      if (!is_turn(s1)) {
+        push_turn(turn(s0, run::Mode::SlalomTurnRight90,
+                       run::Mode::SlalomTurnLeft90),
+                  level, !orthogonal);
+        i += 1;
+      } else if (s1 == s0 && (!is_turn(s2) || s2 == s1)) {
+        push_turn(turn(s0, run::Mode::SlalomTurnRight180,
+                       run::Mode::SlalomTurnLeft180),
+                  level, !orthogonal);
+        i += 2;
+      } else if (s1 == s0) {
+        push_turn(turn(s0, run::Mode::SlalomTurnRight135,
+                       run::Mode::SlalomTurnLeft135),
+                  level, !orthogonal);
+        orthogonal = false;
+        i += 2;
+      } else {
+        push_turn(turn(s0, run::Mode::SlalomTurnRight45,
+                       run::Mode::SlalomTurnLeft45),
+                  level, !orthogonal);
+        orthogonal = false;
+        i += 1;
+      }
+      continue;
+    }
+
+    // 斜め: 旋回が交互に続く間は斜め直進
+    if (is_turn(s1) && s1 != s0) {
+      diagonal++;
+      i++;
+      continue;
+    }
+    push_straight(run::Mode::Diagonal,
+                  DIAGONAL_UNIT * static_cast<float>(diagonal), level);
+    diagonal = 0;
+    if (!is_turn(s1)) {
+      push_turn(turn(s0, run::Mode::SlalomTurnRight45,
+                     run::Mode::SlalomTurnLeft45),
+                level, !orthogonal);
+      orthogonal = true;
+      i += 1;
+    } else if (is_turn(s2) && s2 != s1) {
+      push_turn(turn(s0, run::Mode::SlalomTurnVRight90,
+                     run::Mode::SlalomTurnVLeft90),
+                level, !orthogonal);
+      i += 2;
+    } else {
+      push_turn(turn(s0, run::Mode::SlalomTurnRight135,
+                     run::Mode::SlalomTurnLeft135),
+                level, !orthogonal);
+      orthogonal = true;
+      i += 2;
+    }
+  }
+
+  plan_velocities();
+  select_levels(level);
+
+  // 旋回は計画した速度での等速、直進はS字加減速で見積もる
+  // 計画した境界の速度まで加減速しきれない直進があれば経路としない
+  data::SCurve curve;
+  for (const auto &param : route_) {
+    if (is_straight(param)) {
+      curve.reset(param.length, param.start_velocity, param.end_velocity,
+                  param.max_velocity, param.max_acceleration, param.max_jerk);
+      if (!curve.feasible()) {
+        route_.clear();
+        time_ = 0.0f;
+        return false;
+      }
+      time_ += curve.duration();
+    } else {
+      time_ += param.length / std::max(param.start_velocity, 1e-3f);
+    }
+  }
+  return true;
+}
+}  // namespace maze
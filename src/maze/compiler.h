@@ -0,0 +1,90 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <vector>
+
+// Project
+#include "config.h"
+#include "maze.h"
+#include "run.h"
+
+namespace maze {
+/**
+ * @brief 区画の経路を走行モードの列に変換する
+ * @details
+ * 区画ごとの旋回(直進・右・左)の列を状態機械で走査し、
+ * 連続する直進をまとめ、45・90・135・180度とV90のスラローム旋回、
+ * 斜め直進を認識して最小個数の run::Parameter の列にする。
+ * 旋回の形状は slalom::PROFILES に従い、前後の直進が負の旋回は
+ * 隣の直進を短縮する。
+ * 区間の境界の速度は経路全体で計画する。
+ * 旋回速度・最高速度を上限として、前向きに直進で加速して到達できる速度、
+ * 後ろ向きに次の区間の開始速度まで減速できる速度で境界の速度を下げるため、
+ * 長い直進は加速しきり、短い直進が続いても旋回の手前で減速が間に合う。
+ * 旋回は境界の速度で等速に走る (形状は速度によらない)。
+ * 旋回速度は旋回の形状ごとに走行レベルの角速度・角加速度の制限で抑える。
+ * 旋回は指定された走行レベルで走り、直進・斜め直進は計画した速度のもとで
+ * 走行時間が指定レベルとほぼ変わらない範囲で最も低い走行レベルを選ぶ。
+ */
+class Compiler {
+ public:
+  using Path = std::vector<Position>;
+  using Route = std::vector<run::Parameter>;
+
+  /// 直進の走行レベルを下げてよい走行時間の増加率
+  static constexpr float TIME_MARGIN = 0.01f;
+
+ private:
+  //! 設定
+  const config::Config &conf_;
+  //! 経路
+  Route route_;
+  //! 見積もり走行時間 [s]
+  float time_{0.0f};
+  //! 直前の旋回で次の直進を短縮する距離 [mm] (0以下)
+  float carry_{0.0f};
+  //! 区間の境界の速度 [mm/s] (route_の区間数 + 1)
+  std::vector<float> velocities_;
+
+  void push_straight(run::Mode mode, float length, run::Level level);
+  void push_turn(run::Mode mode, run::Level level, bool diagonal);
+  void plan_velocities();
+  void select_levels(run::Level level);
+
+ public:
+  explicit Compiler(const config::Config &conf) : conf_(conf) {}
+  ~Compiler() = default;
+
+  /**
+   * @brief 既知の壁のみを通る歩数最小の区画の経路を求める
+   * @details 同じ歩数なら直進を優先する。
+   * @return スタート区画からゴール区画までの経路 (到達できなければ空)
+   */
+  static Path path(const Maze &maze, Position goal);
+
+  /**
+   * @brief 区画fromに方角dirで進入した状態からの経路を求める
+   * @return fromからゴール区画までの経路 (到達できなければ空)
+   */
+  static Path path(const Maze &maze, Position from, Direction dir,
+                   Position goal);
+
+  /**
+   * @brief 区画の経路を走行モードの列に変換する
+   * @param path スタート区画からゴール区画までの隣接する区画の列
+   * @param level 旋回の走行レベル (直進の走行レベルの上限)
+   * @return 変換できたか
+   */
+  bool compile(const Path &path, run::Level level);
+
+  /// 走行モードの列で表した経路
+  [[nodiscard]] const Route &route() const { return route_; }
+  /// 区間の境界の速度 [mm/s] (先頭はスタート、末尾はゴールで0)
+  [[nodiscard]] const std::vector<float> &velocities() const {
+    return velocities_;
+  }
+  /// 経路の見積もり走行時間 [s]
+  [[nodiscard]] float time() const { return time_; }
+};
+}  // namespace maze
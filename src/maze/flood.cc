@@ -0,0 +1,85 @@
+#include "flood.h"
+
+// C++
+#include <algorithm>
+#include <bit>
+
+namespace maze {
+void Flood::open_rows(const Maze &maze, Unknown unknown, Rows &east,
+                      Rows &north) {
+  const auto mask = maze.row_mask();
+  for (int y = 0; y < maze.height(); y++) {
+    auto east_walls = maze.east_walls(y);
+    auto north_walls = maze.north_walls(y);
+    if (unknown == Unknown::Wall) {
+      east_walls |= ~maze.east_observed(y);
+      north_walls |= ~maze.north_observed(y);
+    }
+    // 東端・北端は外壁があるので行の外へは展開されない
+    east[y] = ~east_walls & mask;
+    north[y] = ~north_walls & mask;
+  }
+  for (int y = maze.height(); y < MAX_SIZE; y++) {
+    east[y] = 0;
+    north[y] = 0;
+  }
+}
+
+void Flood::update(const Maze &maze, const Rows &goals, Unknown unknown) {
+  const int height = maze.height();
+  const auto mask = maze.row_mask();
+
+  Rows east{}, north{};
+  open_rows(maze, unknown, east, north);
+
+  for (auto &row : distance_) {
+    row.fill(UNREACHABLE);
+  }
+
+  // 目標区画を波面の初期値とする
+  Rows visited{}, frontier{};
+  int low = height, high = -1;
+  for (int y = 0; y < height; y++) {
+    frontier[y] = goals[y] & mask;
+    visited[y] = frontier[y];
+    for (auto bits = frontier[y]; bits != 0; bits &= bits - 1) {
+      distance_[y][std::countr_zero(bits)] = 0;
+    }
+    if (frontier[y] != 0) {
+      low = std::min(low, y);
+      high = std::max(high, y);
+    }
+  }
+
+  steps_ = 0;
+  for (Distance d = 1; low <= high; d++) {
+    Rows next{};
+    const int begin = std::max(low - 1, 0);
+    const int end = std::min(high + 1, height - 1);
+    low = height;
+    high = -1;
+    for (int y = begin; y <= end; y++) {
+      const auto f = frontier[y];
+      // 東西方向への展開
+      auto n = ((f & east[y]) << 1) | ((f >> 1) & east[y]);
+      // 南北方向への展開
+      if (y > 0) n |= frontier[y - 1] & north[y - 1];
+      if (y + 1 < height) n |= frontier[y + 1] & north[y];
+      n &= ~visited[y];
+      next[y] = n;
+      if (n != 0) {
+        low = std::min(low, y);
+        high = std::max(high, y);
+      }
+    }
+    for (int y = begin; y <= end; y++) {
+      visited[y] |= next[y];
+      for (auto bits = next[y]; bits != 0; bits &= bits - 1) {
+        distance_[y][std::countr_zero(bits)] = d;
+      }
+    }
+    frontier = next;
+    steps_++;
+  }
+}
+}  // namespace maze
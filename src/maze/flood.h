@@ -0,0 +1,87 @@
+#pragma once
+
+// C++
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+// Project
+#include "maze.h"
+
+namespace maze {
+/**
+ * @brief 歩数マップ
+ * @details
+ * 行ごとの32bitマスクで波面を保持し、シフトと壁マスクのANDで
+ * 1行ずつ同時に展開する。キューを用いた区画ごとの幅優先探索と異なり、
+ * 1歩あたりの計算量は波面が存在する行数に比例する。
+ */
+class Flood {
+ public:
+  using Rows = Maze::Rows;
+  using Distance = uint16_t;
+
+  /// 到達できない区画の歩数
+  static constexpr Distance UNREACHABLE = UINT16_MAX;
+
+  // 未観測の壁の扱い
+  enum class Unknown {
+    /// 壁がないものとする (楽観的)
+    Open,
+    /// 壁があるものとする (悲観的)
+    Wall,
+  };
+
+ private:
+  //! 歩数 [y][x]
+  std::array<std::array<Distance, MAX_SIZE>, MAX_SIZE> distance_{};
+  //! 最後に展開した波面の数
+  int steps_{0};
+
+ public:
+  explicit Flood() { distance_.fill({}); }
+  ~Flood() = default;
+
+  /**
+   * @brief 区画の集合を表す行マスクを作る
+   */
+  static Rows cells(std::initializer_list<Position> positions) {
+    Rows rows{};
+    for (const auto &pos : positions) {
+      rows[pos.y] |= Maze::Row{1} << pos.x;
+    }
+    return rows;
+  }
+
+  /**
+   * @brief 移動可能な方向の行マスクを作る
+   * @param east 東へ移動可能な区画
+   * @param north 北へ移動可能な区画
+   */
+  static void open_rows(const Maze &maze, Unknown unknown, Rows &east,
+                        Rows &north);
+
+  /**
+   * @brief 目標区画からの歩数マップを作り直す
+   * @param goals 目標区画 (歩数0) の行マスク
+   */
+  void update(const Maze &maze, const Rows &goals, Unknown unknown);
+
+  /**
+   * @brief 区画の歩数 (到達できない場合はUNREACHABLE)
+   */
+  [[nodiscard]] Distance distance(Position pos) const {
+    return distance_[pos.y][pos.x];
+  }
+  /**
+   * @brief 区画の歩数を書き換える (差分更新用)
+   */
+  void set_distance(Position pos, Distance distance) {
+    distance_[pos.y][pos.x] = distance;
+  }
+  /**
+   * @brief 最後の更新で展開した波面の数
+   */
+  [[nodiscard]] int steps() const { return steps_; }
+};
+}  // namespace maze
@@ -0,0 +1,127 @@
+#include "incremental.h"
+
+// C++
+#include <algorithm>
+
+namespace maze {
+namespace {
+// 最小ヒープの比較関数
+constexpr auto greater_key = [](const auto &a, const auto &b) {
+  return a.key > b.key;
+};
+}  // namespace
+
+bool Incremental::is_open(const Maze &maze, Position pos, Direction dir) const {
+  if (maze.is_wall(pos, dir)) {
+    return false;
+  }
+  if (unknown_ == Flood::Unknown::Wall && !maze.is_observed(pos, dir)) {
+    return false;
+  }
+  return maze.contains(neighbor(pos, dir));
+}
+
+Incremental::Distance Incremental::lookahead(const Maze &maze,
+                                             Position pos) const {
+  Distance ret = Flood::UNREACHABLE;
+  for (int d = 0; d < 4; d++) {
+    const auto dir = static_cast<Direction>(d);
+    if (!is_open(maze, pos, dir)) {
+      continue;
+    }
+    const auto g = flood_.distance(neighbor(pos, dir));
+    if (g != Flood::UNREACHABLE) {
+      ret = std::min<Distance>(ret, g + 1);
+    }
+  }
+  return ret;
+}
+
+void Incremental::push(Position pos) {
+  if (queue_size_ == QUEUE_SIZE) {
+    overflow_ = true;
+    return;
+  }
+  queue_[queue_size_++] = {std::min(flood_.distance(pos), rhs(pos)), pos};
+  std::push_heap(queue_.begin(), queue_.begin() + queue_size_, greater_key);
+}
+
+bool Incremental::pop(Entry &entry) {
+  while (queue_size_ > 0) {
+    std::pop_heap(queue_.begin(), queue_.begin() + queue_size_, greater_key);
+    entry = queue_[--queue_size_];
+    // 既に整合した区画・キーが古い要素は読み捨てる
+    const auto g = flood_.distance(entry.pos);
+    const auto r = rhs(entry.pos);
+    if (g != r && entry.key == std::min(g, r)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Incremental::update_vertex(const Maze &maze, Position pos) {
+  if (!is_goal(pos)) {
+    rhs_[pos.y][pos.x] = lookahead(maze, pos);
+  }
+  if (flood_.distance(pos) != rhs(pos)) {
+    push(pos);
+  }
+}
+
+void Incremental::reset(const Maze &maze, const Rows &goals) {
+  goals_ = goals;
+  flood_.update(maze, goals_, unknown_);
+  for (int y = 0; y < MAX_SIZE; y++) {
+    for (int x = 0; x < MAX_SIZE; x++) {
+      rhs_[y][x] = flood_.distance({static_cast<int8_t>(x),
+                                    static_cast<int8_t>(y)});
+    }
+  }
+  queue_size_ = 0;
+  overflow_ = false;
+  expansions_ = 0;
+  recomputed_ = true;
+}
+
+void Incremental::invalidate(const Maze &maze, Position pos, Direction dir) {
+  const auto next = neighbor(pos, dir);
+  if (maze.contains(pos)) {
+    update_vertex(maze, pos);
+  }
+  if (maze.contains(next)) {
+    update_vertex(maze, next);
+  }
+}
+
+void Incremental::repair(const Maze &maze) {
+  expansions_ = 0;
+  recomputed_ = false;
+
+  Entry entry{};
+  while (!overflow_ && expansions_ < MAX_EXPANSIONS && pop(entry)) {
+    const auto pos = entry.pos;
+    expansions_++;
+    if (flood_.distance(pos) > rhs(pos)) {
+      // 歩数が減少した区画: 確定して隣接区画へ伝播
+      flood_.set_distance(pos, rhs(pos));
+    } else {
+      // 歩数が増加した区画: 一旦到達不能として自身と隣接区画を見積もり直す
+      flood_.set_distance(pos, Flood::UNREACHABLE);
+      update_vertex(maze, pos);
+    }
+    for (int d = 0; d < 4; d++) {
+      const auto dir = static_cast<Direction>(d);
+      if (is_open(maze, pos, dir)) {
+        update_vertex(maze, neighbor(pos, dir));
+      }
+    }
+  }
+
+  // 上限に達した時点で不整合な区画が残っていれば全体を再計算する
+  // (キューに残るのが読み捨てる要素のみなら差分更新は完了している)
+  if (overflow_ || pop(entry)) {
+    reset(maze, goals_);
+  }
+}
+}  // namespace maze
@@ -0,0 +1,98 @@
+#pragma once
+
+// C++
+#include <array>
+#include <cstdint>
+
+// Project
+#include "flood.h"
+#include "maze.h"
+
+namespace maze {
+/**
+ * @brief 壁の発見に合わせて歩数マップを差分更新する
+ * @details
+ * LPA* (Lifelong Planning A*) と同様に、各区画の歩数gと
+ * 隣接区画から見積もった歩数rhsを保持し、g != rhs となった区画のみを
+ * キー min(g, rhs) の小さい順に展開する。
+ * 1回の更新で展開する区画数が MAX_EXPANSIONS を超えた場合は
+ * Flood による全体の再計算に切り替えるため、最悪実行時間が抑えられる。
+ */
+class Incremental {
+ public:
+  using Distance = Flood::Distance;
+  using Rows = Flood::Rows;
+
+  /// 1回の更新で展開する区画数の上限
+  /// (探索の模擬で上位1%の更新が全体の再計算の数倍に収まる程度とする)
+  static constexpr int MAX_EXPANSIONS = 64;
+
+ private:
+  //! 優先度付きキューの容量
+  static constexpr std::size_t QUEUE_SIZE = MAX_EXPANSIONS * 4 + 16;
+
+  // キューの要素
+  struct Entry {
+    Distance key;
+    Position pos;
+  };
+
+  //! 未観測の壁の扱い
+  Flood::Unknown unknown_;
+  //! 目標区画
+  Rows goals_{};
+  //! 歩数 (g)
+  Flood flood_;
+  //! 隣接区画から見積もった歩数 (rhs)
+  std::array<std::array<Distance, MAX_SIZE>, MAX_SIZE> rhs_{};
+  //! 不整合な区画のキュー (二分ヒープ)
+  std::array<Entry, QUEUE_SIZE> queue_{};
+  std::size_t queue_size_{0};
+  //! キューが溢れたか
+  bool overflow_{false};
+  //! 最後の更新で展開した区画数
+  int expansions_{0};
+  //! 最後の更新で全体を再計算したか
+  bool recomputed_{false};
+
+  [[nodiscard]] bool is_goal(Position pos) const {
+    return (goals_[pos.y] >> pos.x) & 0x01;
+  }
+  [[nodiscard]] Distance rhs(Position pos) const { return rhs_[pos.y][pos.x]; }
+
+  bool is_open(const Maze &maze, Position pos, Direction dir) const;
+  Distance lookahead(const Maze &maze, Position pos) const;
+  void push(Position pos);
+  bool pop(Entry &entry);
+  void update_vertex(const Maze &maze, Position pos);
+
+ public:
+  explicit Incremental(Flood::Unknown unknown = Flood::Unknown::Open)
+      : unknown_(unknown) {}
+  ~Incremental() = default;
+
+  /**
+   * @brief 歩数マップを全体計算で初期化する
+   */
+  void reset(const Maze &maze, const Rows &goals);
+
+  /**
+   * @brief 壁の変化を登録する (repair()を呼ぶまで歩数マップは更新されない)
+   */
+  void invalidate(const Maze &maze, Position pos, Direction dir);
+
+  /**
+   * @brief 登録された壁の変化に影響される区画のみ歩数を更新する
+   */
+  void repair(const Maze &maze);
+
+  [[nodiscard]] const Flood &flood() const { return flood_; }
+  [[nodiscard]] Distance distance(Position pos) const {
+    return flood_.distance(pos);
+  }
+  /// 最後の更新で展開した区画数
+  [[nodiscard]] int expansions() const { return expansions_; }
+  /// 最後の更新で全体を再計算したか
+  [[nodiscard]] bool recomputed() const { return recomputed_; }
+};
+}  // namespace maze
@@ -0,0 +1,135 @@
+#include "journal.h"
+
+// C++
+#include <array>
+
+// POSIX
+#include <unistd.h>
+
+// ESP-IDF
+#include <esp_log.h>
+
+namespace maze {
+namespace {
+constexpr std::array<Direction, 4> DIRECTIONS = {
+    Direction::North, Direction::East, Direction::South, Direction::West};
+}  // namespace
+
+Journal::Record Journal::record(const Maze &maze, Position pos) {
+  Record record{static_cast<uint8_t>(pos.x), static_cast<uint8_t>(pos.y), 0,
+                0, 0};
+  for (std::size_t i = 0; i < DIRECTIONS.size(); i++) {
+    const auto dir = DIRECTIONS[i];
+    // 外壁は記録しない
+    if (!maze.contains(neighbor(pos, dir)) || !maze.is_observed(pos, dir)) {
+      continue;
+    }
+    record.walls |= static_cast<uint8_t>(0x10 << i);
+    if (maze.is_wall(pos, dir)) {
+      record.walls |= static_cast<uint8_t>(0x01 << i);
+    }
+  }
+  record.check = record.checksum();
+  return record;
+}
+
+bool Journal::read(std::string_view path, Maze &maze, Position goal) {
+  auto file = std::fopen(std::string(path).c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  Header header{};
+  if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+      header.magic != MAGIC || header.width != maze.width() ||
+      header.height != maze.height() || header.goal_x != goal.x ||
+      header.goal_y != goal.y) {
+    std::fclose(file);
+    return false;
+  }
+  records_ = 0;
+  Record record{};
+  while (std::fread(&record, sizeof(record), 1, file) == 1) {
+    const Position pos{static_cast<int8_t>(record.x),
+                       static_cast<int8_t>(record.y)};
+    if (record.check != record.checksum() || !maze.contains(pos)) {
+      ESP_LOGW(TAG, "Corrupted record after %d records", records_);
+      break;
+    }
+    for (std::size_t i = 0; i < DIRECTIONS.size(); i++) {
+      if ((record.walls >> (i + 4)) & 0x01) {
+        maze.set_wall(pos, DIRECTIONS[i], (record.walls >> i) & 0x01);
+      }
+    }
+    records_++;
+  }
+  std::fclose(file);
+  return true;
+}
+
+bool Journal::flush(std::FILE *file) {
+  return std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+}
+
+bool Journal::write(const Record &record) {
+  return file_ != nullptr &&
+         std::fwrite(&record, sizeof(record), 1, file_) == 1 && flush(file_);
+}
+
+bool Journal::load(Maze &maze, Position goal) {
+  // 置き換えの途中で途切れた場合は一時ファイルが残っている
+  if (read(path_, maze, goal) || read(temporary_path_, maze, goal)) {
+    ESP_LOGI(TAG, "Loaded %d records", records_);
+    return true;
+  }
+  return false;
+}
+
+bool Journal::create(const Maze &maze, Position goal) {
+  close();
+  auto file = std::fopen(temporary_path_.c_str(), "wb");
+  if (file == nullptr) {
+    ESP_LOGE(TAG, "Failed to open %s", temporary_path_.c_str());
+    return false;
+  }
+  const Header header{MAGIC, static_cast<uint8_t>(maze.width()),
+                      static_cast<uint8_t>(maze.height()),
+                      static_cast<uint8_t>(goal.x),
+                      static_cast<uint8_t>(goal.y)};
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+  for (int8_t y = 0; y < maze.height(); y++) {
+    for (int8_t x = 0; x < maze.width(); x++) {
+      const auto r = record(maze, {x, y});
+      if (r.walls != 0) {
+        ok = ok && std::fwrite(&r, sizeof(r), 1, file) == 1;
+      }
+    }
+  }
+  ok = flush(file) && ok;
+  std::fclose(file);
+  if (!ok) {
+    ESP_LOGE(TAG, "Failed to write %s", temporary_path_.c_str());
+    std::remove(temporary_path_.c_str());
+    return false;
+  }
+  // SPIFFSは既存のファイルへのrenameができないため、先に削除する
+  std::remove(path_.c_str());
+  if (std::rename(temporary_path_.c_str(), path_.c_str()) != 0) {
+    ESP_LOGE(TAG, "Failed to rename %s", temporary_path_.c_str());
+    return false;
+  }
+  file_ = std::fopen(path_.c_str(), "ab");
+  return file_ != nullptr;
+}
+
+bool Journal::append(const Maze &maze, Position pos) {
+  return write(record(maze, pos));
+}
+bool Journal::append(const Record &record) { return write(record); }
+
+void Journal::close() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+}  // namespace maze
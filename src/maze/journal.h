@@ -0,0 +1,113 @@
+#pragma once
+
+// C++
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// ESP-IDF
+#include <esp_rom_crc.h>
+
+// Project
+#include "maze.h"
+
+namespace maze {
+/**
+ * @brief 探索中の壁情報を追記するファイル
+ * @details
+ * ファイルの先頭に迷路の大きさとゴールを記録したヘッダを置き、
+ * 以降は区画ごとに8byteの固定長レコード (CRC32付き) を追記する。
+ * 区画に進入するたびに追記してフラッシュするため、
+ * 探索中に非常停止やリセットが起きても直前の区画までの壁情報が残る。
+ * 書き込み途中で途切れたレコードや化けたレコードはCRC32で検出し、
+ * そこで読み込みを打ち切る。
+ * 読み込み後は有効なレコードのみで一時ファイルに書き直してから置き換える。
+ */
+class Journal {
+ public:
+  // 区画ごとのレコード
+  struct Record {
+    uint8_t x;
+    uint8_t y;
+    //! 下位4bit: 壁の有無, 上位4bit: 観測済みか (bit0から北・東・南・西)
+    uint8_t walls;
+    uint8_t reserved;
+    //! checkより前のCRC32
+    uint32_t check;
+
+    [[nodiscard]] uint32_t checksum() const {
+      return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(this),
+                              offsetof(Record, check));
+    }
+  };
+  static_assert(sizeof(Record) == 8);
+
+ private:
+  static constexpr auto TAG = "maze::Journal";
+  //! ヘッダの識別子
+  //! (レコードの形式を変えたら変える。版1は8bitのチェックサム)
+  static constexpr uint32_t MAGIC = 0x324A5A4D;  // "MZJ2"
+
+  // ヘッダ
+  struct Header {
+    uint32_t magic;
+    uint8_t width;
+    uint8_t height;
+    uint8_t goal_x;
+    uint8_t goal_y;
+  };
+  static_assert(sizeof(Header) == 8);
+
+  //! ファイルのパス
+  std::string path_;
+  //! 置き換え用の一時ファイルのパス
+  std::string temporary_path_;
+  //! 追記中のファイル
+  std::FILE *file_{nullptr};
+  //! 最後に読み込んだレコード数
+  int records_{0};
+
+  bool read(std::string_view path, Maze &maze, Position goal);
+  bool write(const Record &record);
+  static bool flush(std::FILE *file);
+
+ public:
+  explicit Journal(std::string_view path)
+      : path_(path), temporary_path_(std::string(path) + ".tmp") {}
+  ~Journal() { close(); }
+
+  /**
+   * @brief 記録された壁情報を迷路に反映する
+   * @param maze 初期化済みの迷路
+   * @return 迷路の大きさとゴールが一致する記録を読み込めたか
+   */
+  bool load(Maze &maze, Position goal);
+
+  /**
+   * @brief 迷路の現在の壁情報でファイルを作り直し、追記できる状態にする
+   */
+  bool create(const Maze &maze, Position goal);
+
+  /**
+   * @brief 区画の四方の壁をレコードにする
+   * @details 追記を別のタスクに任せる場合は、迷路ではなくこれを渡す
+   */
+  static Record record(const Maze &maze, Position pos);
+
+  /**
+   * @brief 区画の四方の壁を追記し、ストレージへ書き出す
+   */
+  bool append(const Maze &maze, Position pos);
+  bool append(const Record &record);
+
+  /**
+   * @brief ファイルを閉じる
+   */
+  void close();
+
+  /// 最後に読み込んだレコード数
+  [[nodiscard]] int records() const { return records_; }
+};
+}  // namespace maze
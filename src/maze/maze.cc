@@ -0,0 +1,54 @@
+#include "maze.h"
+
+// C++
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace maze {
+[[maybe_unused]] bool Maze::read_file(std::string_view path) {
+  std::ifstream file((std::string(path)));
+  if (!file) {
+    return false;
+  }
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (!line.empty()) {
+      lines.push_back(line);
+    }
+  }
+  if (lines.size() < 3) {
+    return false;
+  }
+
+  const int width = static_cast<int>(lines.front().size() - 1) / 4;
+  const int height = static_cast<int>(lines.size() - 1) / 2;
+  if (width < 1 || width > MAX_SIZE || height < 1 || height > MAX_SIZE) {
+    return false;
+  }
+  width_ = width;
+  height_ = height;
+  reset();
+
+  auto at = [&](std::size_t row, std::size_t col) {
+    return col < lines[row].size() ? lines[row][col] : ' ';
+  };
+  for (int y = 0; y < height_; y++) {
+    // テキストの行は北から南の順
+    const auto row = static_cast<std::size_t>(height_ - 1 - y) * 2;
+    for (int x = 0; x < width_; x++) {
+      const auto col = static_cast<std::size_t>(x) * 4;
+      const Position pos{static_cast<int8_t>(x), static_cast<int8_t>(y)};
+      set_wall(pos, Direction::North, at(row, col + 2) == '-');
+      set_wall(pos, Direction::East, at(row + 1, col + 4) == '|');
+      set_wall(pos, Direction::South, at(row + 2, col + 2) == '-');
+      set_wall(pos, Direction::West, at(row + 1, col) == '|');
+    }
+  }
+  return true;
+}
+}  // namespace maze
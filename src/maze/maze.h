@@ -0,0 +1,216 @@
+#pragma once
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace maze {
+/// 迷路の最大サイズ (1辺の区画数)
+static constexpr int MAX_SIZE = 32;
+/// 区画の大きさ [mm]
+static constexpr float CELL_SIZE = 90.0f;
+
+// 方角
+enum class Direction : uint8_t { North, East, South, West };
+
+// 区画の座標
+struct Position {
+  int8_t x;
+  int8_t y;
+
+  bool operator==(const Position &) const = default;
+};
+
+/**
+ * @brief 方角を右回りにn回(90度単位)回転する
+ */
+constexpr Direction rotate(Direction dir, int n) {
+  return static_cast<Direction>((static_cast<int>(dir) + n) & 0x03);
+}
+
+/**
+ * @brief 隣の区画の座標を返す
+ */
+constexpr Position neighbor(Position pos, Direction dir) {
+  switch (dir) {
+    case Direction::North:
+      return {pos.x, static_cast<int8_t>(pos.y + 1)};
+    case Direction::East:
+      return {static_cast<int8_t>(pos.x + 1), pos.y};
+    case Direction::South:
+      return {pos.x, static_cast<int8_t>(pos.y - 1)};
+    default:
+    case Direction::West:
+      return {static_cast<int8_t>(pos.x - 1), pos.y};
+  }
+}
+
+/**
+ * @brief 迷路の壁情報
+ * @details
+ * 隣り合う区画が共有する壁を一度だけ保持する。
+ * 行(y)ごとに32bitのマスクを持ち、bit xが区画(x, y)に対応する。
+ * - east_: 区画の東側の壁 (西側の壁は x - 1 の東側の壁)
+ * - north_: 区画の北側の壁 (南側の壁は y - 1 の北側の壁)
+ * 迷路の西端・南端の外壁は常に存在するものとして扱う。
+ * 壁の有無と観測済みかどうかをそれぞれ別のビットプレーンで保持する。
+ */
+class Maze {
+ public:
+  using Row = uint32_t;
+  using Rows = std::array<Row, MAX_SIZE>;
+
+ private:
+  //! 迷路の幅・高さ
+  int width_;
+  int height_;
+
+  //! 壁の有無
+  Rows east_{};
+  Rows north_{};
+
+  //! 壁を観測済みか
+  Rows east_observed_{};
+  Rows north_observed_{};
+
+  // 壁の格納位置
+  struct Location {
+    //! 外壁(西端・南端)か
+    bool outer;
+    //! 東側の壁のプレーンか (falseなら北側の壁のプレーン)
+    bool east;
+    //! 行
+    int row;
+    //! ビット
+    Row bit;
+  };
+
+  /**
+   * @brief 区画と方角から壁の格納位置を求める
+   */
+  static constexpr Location locate(Position pos, Direction dir) {
+    switch (dir) {
+      case Direction::North:
+        return {false, false, pos.y, Row{1} << pos.x};
+      case Direction::East:
+        return {false, true, pos.y, Row{1} << pos.x};
+      case Direction::South:
+        if (pos.y == 0) return {true, false, 0, 0};
+        return {false, false, pos.y - 1, Row{1} << pos.x};
+      default:
+      case Direction::West:
+        if (pos.x == 0) return {true, true, 0, 0};
+        return {false, true, pos.y, Row{1} << (pos.x - 1)};
+    }
+  }
+
+ public:
+  /**
+   * @param size 迷路の大きさ (config::Config::maze_size)
+   */
+  explicit Maze(const std::array<int, 2> &size)
+      : width_(std::clamp(size[0], 1, MAX_SIZE)),
+        height_(std::clamp(size[1], 1, MAX_SIZE)) {
+    reset();
+  }
+  ~Maze() = default;
+
+  /**
+   * @brief 外壁とスタート区画の壁のみの状態に戻す
+   */
+  void reset() {
+    east_.fill(0);
+    north_.fill(0);
+    east_observed_.fill(0);
+    north_observed_.fill(0);
+    // 東端・北端の外壁
+    const Row east_edge = Row{1} << (width_ - 1);
+    for (int y = 0; y < height_; y++) {
+      east_[y] = east_edge;
+      east_observed_[y] = east_edge;
+    }
+    north_[height_ - 1] = row_mask();
+    north_observed_[height_ - 1] = row_mask();
+    // スタート区画は東側に壁がある
+    if (width_ > 1) {
+      set_wall({0, 0}, Direction::East, true);
+    }
+  }
+
+  [[nodiscard]] int width() const { return width_; }
+  [[nodiscard]] int height() const { return height_; }
+  /// 迷路内の区画を表す行マスク
+  [[nodiscard]] Row row_mask() const {
+    return width_ == MAX_SIZE ? ~Row{0} : (Row{1} << width_) - 1;
+  }
+  /// 迷路内の区画か
+  [[nodiscard]] bool contains(Position pos) const {
+    return pos.x >= 0 && pos.x < width_ && pos.y >= 0 && pos.y < height_;
+  }
+
+  /**
+   * @brief 壁があるか (未観測の壁はないものとして扱う)
+   */
+  [[nodiscard]] bool is_wall(Position pos, Direction dir) const {
+    const auto loc = locate(pos, dir);
+    const auto &plane = loc.east ? east_ : north_;
+    return loc.outer || (plane[loc.row] & loc.bit) != 0;
+  }
+  /**
+   * @brief 壁を観測済みか
+   */
+  [[nodiscard]] bool is_observed(Position pos, Direction dir) const {
+    const auto loc = locate(pos, dir);
+    const auto &plane = loc.east ? east_observed_ : north_observed_;
+    return loc.outer || (plane[loc.row] & loc.bit) != 0;
+  }
+  /**
+   * @brief 区画の四方の壁を全て観測済みか
+   */
+  [[nodiscard]] bool is_visited(Position pos) const {
+    return is_observed(pos, Direction::North) &&
+           is_observed(pos, Direction::East) &&
+           is_observed(pos, Direction::South) &&
+           is_observed(pos, Direction::West);
+  }
+
+  /**
+   * @brief 壁を観測結果で更新する
+   * @return 壁情報が変化したか
+   */
+  bool set_wall(Position pos, Direction dir, bool exists) {
+    const auto loc = locate(pos, dir);
+    // 外壁は変更しない
+    if (loc.outer || !contains(neighbor(pos, dir))) {
+      return false;
+    }
+    auto &row = (loc.east ? east_ : north_)[loc.row];
+    auto &observed = (loc.east ? east_observed_ : north_observed_)[loc.row];
+    const Row prev = row;
+    const bool was_observed = (observed & loc.bit) != 0;
+    row = exists ? (prev | loc.bit) : (prev & ~loc.bit);
+    observed |= loc.bit;
+    return !was_observed || prev != row;
+  }
+
+  /**
+   * @brief 迷路のテキストファイルを読み込む
+   * @details
+   * 大会迷路の配布で一般的な形式 (柱を'o'または'+'、壁を"---"・'|'で表し、
+   * 1行目が北端) を読み込み、全ての壁を観測済みとする。
+   * 迷路の大きさはファイルから決まる。
+   */
+  [[maybe_unused]] bool read_file(std::string_view path);
+
+  /// 行yの東側の壁マスク
+  [[nodiscard]] Row east_walls(int y) const { return east_[y]; }
+  /// 行yの北側の壁マスク
+  [[nodiscard]] Row north_walls(int y) const { return north_[y]; }
+  /// 行yの東側の壁の観測済みマスク
+  [[nodiscard]] Row east_observed(int y) const { return east_observed_[y]; }
+  /// 行yの北側の壁の観測済みマスク
+  [[nodiscard]] Row north_observed(int y) const { return north_observed_[y]; }
+};
+}  // namespace maze
@@ -0,0 +1,474 @@
+#include "planner.h"
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <span>
+#include <vector>
+
+// Project
+#include "data/scurve.h"
+#include "slalom.h"
+
+namespace maze {
+namespace {
+/**
+ * 座標は区画の半分を1とする格子で表す。
+ * 区画(x, y)の中心は(2x + 1, 2y + 1)、北側の壁の中点は(2x + 1, 2y + 2)、
+ * 東側の壁の中点は(2x + 2, 2y + 1)となり、壁の中点は片方の座標のみ偶数となる。
+ * 進行方向は北から右回りに45度ずつ0 ~ 7で表す。
+ */
+struct Point {
+  int x;
+  int y;
+};
+
+constexpr int HEADINGS = 8;
+constexpr int DX[HEADINGS] = {0, 1, 1, 1, 0, -1, -1, -1};
+constexpr int DY[HEADINGS] = {1, 1, 0, -1, -1, -1, 0, 1};
+constexpr uint8_t NORTH = 0;
+constexpr uint8_t EAST = 2;
+
+//! 1つの壁エッジあたりのノード数 (直交2方向・斜め4方向)
+constexpr int SLOTS = 6;
+//! 直進・斜め直進の1単位の距離 [mm]
+constexpr float STRAIGHT_UNIT = CELL_SIZE;
+constexpr float DIAGONAL_UNIT = run::DIAGONAL_UNIT;
+
+// 走行パターン
+struct Move {
+  run::Mode mode;
+  //! 終点の相対座標
+  Point end;
+  //! 終点での進行方向
+  uint8_t heading;
+  //! 通過する壁の中点
+  uint8_t crosses;
+  Point cross[2];
+  //! 始点から終点までの走行距離 [mm]
+  float length;
+  //! 旋回角度 [rad] (左旋回が正)
+  float angle;
+};
+
+constexpr float PI = std::numbers::pi_v<float>;
+
+// 旋回の始点から終点までの走行距離 [mm]
+constexpr float distance(slalom::Shape shape) {
+  return slalom::PROFILES[static_cast<std::size_t>(shape)].distance();
+}
+constexpr float TURN45 = distance(slalom::Shape::Turn45);
+constexpr float TURN90 = distance(slalom::Shape::Turn90);
+constexpr float TURN135 = distance(slalom::Shape::Turn135);
+constexpr float TURN180 = distance(slalom::Shape::Turn180);
+constexpr float TURNV90 = distance(slalom::Shape::TurnV90);
+
+// 北向きで水平な壁の中点から始まる旋回
+constexpr Move ORTHOGONAL_MOVES[] = {
+    {run::Mode::SlalomTurnRight90, {1, 1}, 2, 1, {{1, 1}}, TURN90, -PI / 2},
+    {run::Mode::SlalomTurnLeft90, {-1, 1}, 6, 1, {{-1, 1}}, TURN90, PI / 2},
+    {run::Mode::SlalomTurnRight180, {2, 0}, 4, 2, {{1, 1}, {2, 0}}, TURN180,
+     -PI},
+    {run::Mode::SlalomTurnLeft180, {-2, 0}, 4, 2, {{-1, 1}, {-2, 0}}, TURN180,
+     PI},
+    {run::Mode::SlalomTurnRight45, {1, 1}, 1, 1, {{1, 1}}, TURN45, -PI / 4},
+    {run::Mode::SlalomTurnLeft45, {-1, 1}, 7, 1, {{-1, 1}}, TURN45, PI / 4},
+    {run::Mode::SlalomTurnRight135, {2, 0}, 3, 2, {{1, 1}, {2, 0}}, TURN135,
+     -PI * 3 / 4},
+    {run::Mode::SlalomTurnLeft135, {-2, 0}, 5, 2, {{-1, 1}, {-2, 0}}, TURN135,
+     PI * 3 / 4},
+};
+
+// 北東向きで水平な壁の中点から始まる旋回
+// (垂直な壁の中点から始まる場合は直線y = xで反転する)
+constexpr Move DIAGONAL_MOVES[] = {
+    {run::Mode::SlalomTurnRight45, {1, 1}, 2, 1, {{1, 1}}, TURN45, -PI / 4},
+    {run::Mode::SlalomTurnRight135, {2, 0}, 4, 2, {{1, 1}, {2, 0}}, TURN135,
+     -PI * 3 / 4},
+    {run::Mode::SlalomTurnVRight90, {2, 0}, 3, 2, {{1, 1}, {2, 0}}, TURNV90,
+     -PI / 2},
+    {run::Mode::SlalomTurnVLeft90, {0, 2}, 7, 1, {{0, 2}}, TURNV90, PI / 2},
+};
+
+// 左右を入れ替えた走行モード
+constexpr run::Mode mirror(run::Mode mode) {
+  switch (mode) {
+    case run::Mode::SlalomTurnLeft45:
+      return run::Mode::SlalomTurnRight45;
+    case run::Mode::SlalomTurnRight45:
+      return run::Mode::SlalomTurnLeft45;
+    case run::Mode::SlalomTurnLeft90:
+      return run::Mode::SlalomTurnRight90;
+    case run::Mode::SlalomTurnRight90:
+      return run::Mode::SlalomTurnLeft90;
+    case run::Mode::SlalomTurnLeft135:
+      return run::Mode::SlalomTurnRight135;
+    case run::Mode::SlalomTurnRight135:
+      return run::Mode::SlalomTurnLeft135;
+    case run::Mode::SlalomTurnLeft180:
+      return run::Mode::SlalomTurnRight180;
+    case run::Mode::SlalomTurnRight180:
+      return run::Mode::SlalomTurnLeft180;
+    case run::Mode::SlalomTurnVLeft90:
+      return run::Mode::SlalomTurnVRight90;
+    case run::Mode::SlalomTurnVRight90:
+      return run::Mode::SlalomTurnVLeft90;
+    default:
+      return mode;
+  }
+}
+// 直線y = xで反転
+constexpr Point mirror(Point p) { return {p.y, p.x}; }
+constexpr uint8_t mirror(uint8_t heading) { return (2 - heading) & 0x07; }
+// 右回りに90度 * n回転
+constexpr Point rotate(Point p, int n) {
+  for (int i = 0; i < (n & 0x03); i++) {
+    p = {p.y, -p.x};
+  }
+  return p;
+}
+constexpr bool is_horizontal(Point p) { return (p.x & 0x01) != 0; }
+// 隣り合う2つの壁の中点がともに接する区画
+constexpr Position shared(Point a, Point b) {
+  auto center = [](int a, int b) {
+    if (a & 0x01) return a;
+    if (b & 0x01) return b;
+    return (a + b) / 2;
+  };
+  return {static_cast<int8_t>((center(a.x, b.x) - 1) / 2),
+          static_cast<int8_t>((center(a.y, b.y) - 1) / 2)};
+}
+
+/**
+ * @brief ノード番号と壁エッジ・進行方向の変換
+ */
+class Graph {
+ private:
+  const Maze &maze_;
+  const int width_;
+  const int height_;
+  //! 水平な壁エッジの数
+  const int horizontals_;
+
+ public:
+  explicit Graph(const Maze &maze)
+      : maze_(maze),
+        width_(maze.width()),
+        height_(maze.height()),
+        horizontals_((maze.height() + 1) * maze.width()) {}
+
+  [[nodiscard]] int nodes() const {
+    return (horizontals_ + (width_ + 1) * height_) * SLOTS;
+  }
+
+  /**
+   * @brief 壁エッジ番号 (範囲外は-1)
+   */
+  [[nodiscard]] int edge(Point p) const {
+    if (is_horizontal(p)) {
+      const int x = (p.x - 1) / 2, j = p.y / 2;
+      if (p.x < 0 || p.y < 0 || x >= width_ || j > height_) return -1;
+      return j * width_ + x;
+    }
+    const int i = p.x / 2, y = (p.y - 1) / 2;
+    if (p.x < 0 || p.y < 0 || i > width_ || y >= height_) return -1;
+    return horizontals_ + y * (width_ + 1) + i;
+  }
+  [[nodiscard]] Point point(int edge) const {
+    if (edge < horizontals_) {
+      return {(edge % width_) * 2 + 1, (edge / width_) * 2};
+    }
+    edge -= horizontals_;
+    return {(edge % (width_ + 1)) * 2, (edge / (width_ + 1)) * 2 + 1};
+  }
+
+  [[nodiscard]] int node(Point p, uint8_t heading) const {
+    const int e = edge(p);
+    if (e < 0) return -1;
+    int slot;
+    if (heading & 0x01) {
+      slot = heading >> 1;
+    } else {
+      slot = (heading == NORTH || heading == EAST) ? 4 : 5;
+    }
+    return e * SLOTS + slot;
+  }
+  void decode(int node, Point &p, uint8_t &heading) const {
+    p = point(node / SLOTS);
+    const int slot = node % SLOTS;
+    if (slot < 4) {
+      heading = static_cast<uint8_t>(slot * 2 + 1);
+    } else if (is_horizontal(p)) {
+      heading = slot == 4 ? 0 : 4;
+    } else {
+      heading = slot == 4 ? 2 : 6;
+    }
+  }
+
+  /**
+   * @brief 壁の中点を通過できるか (外壁・未観測の壁は通過できない)
+   */
+  [[nodiscard]] bool passable(Point p) const {
+    if (edge(p) < 0) return false;
+    if (is_horizontal(p)) {
+      const int x = (p.x - 1) / 2, j = p.y / 2;
+      if (j == 0 || j == height_) return false;
+      const Position pos{static_cast<int8_t>(x), static_cast<int8_t>(j - 1)};
+      return !maze_.is_wall(pos, Direction::North) &&
+             maze_.is_observed(pos, Direction::North);
+    }
+    const int i = p.x / 2, y = (p.y - 1) / 2;
+    if (i == 0 || i == width_) return false;
+    const Position pos{static_cast<int8_t>(i - 1), static_cast<int8_t>(y)};
+    return !maze_.is_wall(pos, Direction::East) &&
+           maze_.is_observed(pos, Direction::East);
+  }
+
+  /**
+   * @brief 直交方向に進む壁の中点から進入する区画
+   */
+  static Position entering(Point p, uint8_t heading) {
+    return {static_cast<int8_t>((p.x + DX[heading] - 1) / 2),
+            static_cast<int8_t>((p.y + DY[heading] - 1) / 2)};
+  }
+};
+
+/**
+ * @brief ノード番号を走行時間の小さい順に取り出す二分ヒープ
+ */
+class Heap {
+ private:
+  static constexpr uint16_t NONE = UINT16_MAX;
+
+  const std::vector<float> &cost_;
+  std::vector<uint16_t> heap_;
+  std::vector<uint16_t> index_;
+
+  bool less(std::size_t a, std::size_t b) const {
+    return cost_[heap_[a]] < cost_[heap_[b]];
+  }
+  void swap(std::size_t a, std::size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    index_[heap_[a]] = static_cast<uint16_t>(a);
+    index_[heap_[b]] = static_cast<uint16_t>(b);
+  }
+  void up(std::size_t i) {
+    while (i > 0 && less(i, (i - 1) / 2)) {
+      swap(i, (i - 1) / 2);
+      i = (i - 1) / 2;
+    }
+  }
+  void down(std::size_t i) {
+    while (true) {
+      auto min = i;
+      const auto l = i * 2 + 1, r = i * 2 + 2;
+      if (l < heap_.size() && less(l, min)) min = l;
+      if (r < heap_.size() && less(r, min)) min = r;
+      if (min == i) return;
+      swap(i, min);
+      i = min;
+    }
+  }
+
+ public:
+  explicit Heap(const std::vector<float> &cost)
+      : cost_(cost), index_(cost.size(), NONE) {}
+
+  [[nodiscard]] bool empty() const { return heap_.empty(); }
+
+  /**
+   * @brief 追加、またはコストが減少したノードの位置を更新する
+   */
+  void push(uint16_t node) {
+    if (index_[node] == NONE) {
+      heap_.push_back(node);
+      index_[node] = static_cast<uint16_t>(heap_.size() - 1);
+    }
+    up(index_[node]);
+  }
+  uint16_t pop() {
+    const auto top = heap_.front();
+    swap(0, heap_.size() - 1);
+    heap_.pop_back();
+    index_[top] = NONE;
+    if (!heap_.empty()) down(0);
+    return top;
+  }
+};
+}  // namespace
+
+float Planner::travel_time(float length, float v0, float v1,
+                           const run::Parameter &param) {
+  // run::Run の直進と同じS字加減速で見積もる
+  data::SCurve curve;
+  curve.reset(length, v0, v1, param.max_velocity, param.max_acceleration,
+              param.max_jerk);
+  return curve.duration();
+}
+
+float Planner::turn_length(run::Mode mode) {
+  for (const auto &move : ORTHOGONAL_MOVES) {
+    if (move.mode == mode) return move.length;
+  }
+  for (const auto &move : DIAGONAL_MOVES) {
+    if (move.mode == mode || mirror(move.mode) == mode) return move.length;
+  }
+  return 0.0f;
+}
+
+bool Planner::plan(const Maze &maze, Position goal, run::Level level) {
+  const Graph graph(maze);
+  const int nodes = graph.nodes();
+  // スタート区画中央・ゴール区画中央を表す仮想ノード
+  const auto start = static_cast<uint16_t>(nodes);
+  const auto finish = static_cast<uint16_t>(nodes + 1);
+
+  const auto straight = run::parameter(conf_, run::Mode::Straight, level);
+  const auto diagonal = run::parameter(conf_, run::Mode::Diagonal, level);
+  // 旋回の速度 (直進・斜め直進の開始・終了速度)
+  const auto turn = run::parameter(conf_, run::Mode::SlalomTurn, level);
+  const auto turn_velocity = turn.max_velocity;
+  // 旋回の形状ごとに角速度・角加速度の制限で抑えた旋回の速度
+  std::array<float, slalom::SHAPES> shape_velocity{};
+  for (std::size_t i = 0; i < slalom::SHAPES; i++) {
+    shape_velocity[i] = slalom::velocity(slalom::PROFILES[i], turn);
+  }
+  const auto half = CELL_SIZE / 2.0f;
+
+  std::vector<float> cost(nodes + 2, INFINITY);
+  std::vector<uint16_t> parent(nodes + 2, UINT16_MAX);
+  // 直前のエッジ (直進の単位数、または TURN | 旋回の表の添字)
+  constexpr uint16_t TURN = 0x100;
+  std::vector<uint16_t> via(nodes + 2, 0);
+  Heap heap(cost);
+
+  auto relax = [&](uint16_t from, uint16_t to, float c, uint16_t edge) {
+    if (c < cost[to]) {
+      cost[to] = c;
+      parent[to] = from;
+      via[to] = edge;
+      heap.push(to);
+    }
+  };
+  // スタートはスタート区画の南側の壁の中点から北向きに半区画進んだ位置
+  auto decode = [&](uint16_t u, Point &p, uint8_t &heading) {
+    if (u == start) {
+      p = {1, 0};
+      heading = NORTH;
+    } else {
+      graph.decode(u, p, heading);
+    }
+  };
+
+  cost[start] = 0.0f;
+  heap.push(start);
+  while (!heap.empty()) {
+    const auto u = heap.pop();
+    if (u == finish) break;
+
+    Point p;
+    uint8_t heading;
+    decode(u, p, heading);
+    const bool orthogonal = (heading & 0x01) == 0;
+    const int r = orthogonal ? heading / 2 : (heading - 1) / 2;
+    const auto v0 = u == start ? 0.0f : turn_velocity;
+
+    // ゴール区画へ進入する直交方向のノードからは区画中央で停止できる
+    if (u != start && orthogonal && Graph::entering(p, heading) == goal) {
+      relax(u, finish,
+            cost[u] + travel_time(half, turn_velocity, 0.0f, straight), 0);
+    }
+
+    // 直進・斜め直進
+    const Point step = rotate(orthogonal ? Point{0, 2} : Point{1, 1}, r);
+    const auto &limit = orthogonal ? straight : diagonal;
+    const auto unit = orthogonal ? STRAIGHT_UNIT : DIAGONAL_UNIT;
+    Point q = p;
+    for (int k = 1; k < UINT8_MAX; k++) {
+      q = {q.x + step.x, q.y + step.y};
+      if (!graph.passable(q)) break;
+      auto length = unit * static_cast<float>(k);
+      if (u == start) length -= half;
+      const auto v = static_cast<uint16_t>(graph.node(q, heading));
+      relax(u, v, cost[u] + travel_time(length, v0, turn_velocity, limit),
+            static_cast<uint16_t>(k));
+      if (orthogonal && Graph::entering(q, heading) == goal) {
+        relax(u, finish,
+              cost[u] + travel_time(length + half, v0, 0.0f, limit),
+              static_cast<uint16_t>(k));
+      }
+    }
+    if (u == start) continue;
+
+    // スラローム旋回
+    // 斜めの場合は回転を戻した時点で垂直な壁の中点なら反転した表を用いる
+    const bool flip = !orthogonal && (is_horizontal(p) == ((r & 0x01) != 0));
+    auto moves = orthogonal ? std::span<const Move>(ORTHOGONAL_MOVES)
+                            : std::span<const Move>(DIAGONAL_MOVES);
+    for (std::size_t i = 0; i < moves.size(); i++) {
+      const auto &move = moves[i];
+      auto end = flip ? mirror(move.end) : move.end;
+      end = rotate(end, r);
+      bool ok = true;
+      for (int i = 0; i < move.crosses && ok; i++) {
+        auto c = rotate(flip ? mirror(move.cross[i]) : move.cross[i], r);
+        ok = graph.passable({p.x + c.x, p.y + c.y});
+      }
+      if (!ok) continue;
+      const auto h = static_cast<uint8_t>(
+          ((flip ? mirror(move.heading) : move.heading) + r * 2) & 0x07);
+      const auto v = graph.node({p.x + end.x, p.y + end.y}, h);
+      if (v < 0) continue;
+      const auto shape = static_cast<std::size_t>(slalom::shape(move.mode));
+      relax(u, static_cast<uint16_t>(v),
+            cost[u] + move.length / shape_velocity[shape],
+            static_cast<uint16_t>(TURN | i));
+    }
+  }
+
+  time_ = cost[finish];
+  path_.clear();
+  if (parent[finish] == UINT16_MAX) {
+    return false;
+  }
+
+  // 経路を逆にたどり、エッジが通過する壁の中点を順に並べる
+  std::vector<uint16_t> trail;
+  for (auto n = finish; n != start; n = parent[n]) {
+    trail.push_back(n);
+  }
+  std::reverse(trail.begin(), trail.end());
+  std::vector<Point> points{{1, 0}};
+  Point p{1, 0};
+  uint8_t heading = NORTH;
+  for (const auto n : trail) {
+    decode(parent[n], p, heading);
+    const bool orthogonal = (heading & 0x01) == 0;
+    const int r = orthogonal ? heading / 2 : (heading - 1) / 2;
+    if (via[n] & TURN) {
+      const bool flip = !orthogonal && (is_horizontal(p) == ((r & 0x01) != 0));
+      const auto &move = orthogonal ? ORTHOGONAL_MOVES[via[n] & 0xFF]
+                                    : DIAGONAL_MOVES[via[n] & 0xFF];
+      for (int i = 0; i < move.crosses; i++) {
+        const auto c = rotate(flip ? mirror(move.cross[i]) : move.cross[i], r);
+        points.push_back({p.x + c.x, p.y + c.y});
+      }
+      continue;
+    }
+    const Point step = rotate(orthogonal ? Point{0, 2} : Point{1, 1}, r);
+    for (int k = 0; k < via[n]; k++) {
+      p = {p.x + step.x, p.y + step.y};
+      points.push_back(p);
+    }
+  }
+
+  // 隣り合う壁の中点がともに接する区画を並べ、最後にゴール区画へ進入する
+  for (std::size_t i = 1; i < points.size(); i++) {
+    path_.push_back(shared(points[i - 1], points[i]));
+  }
+  path_.push_back(goal);
+  return true;
+}
+}  // namespace maze
@@ -0,0 +1,67 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <vector>
+
+// Project
+#include "config.h"
+#include "maze.h"
+#include "run.h"
+
+namespace maze {
+/**
+ * @brief 走行時間が最小となる最短経路を求める
+ * @details
+ * 区画の壁の中点(壁エッジ)と進行方向の組をノードとし、
+ * 直進・斜め直進・各スラローム旋回をエッジとするグラフ上で
+ * ダイクストラ法により走行時間の最小経路を求める。
+ * エッジのコストは走行レベルの速度・加速度・躍度から見積もった走行時間とする。
+ * 未観測の壁は壁があるものとして扱う。
+ * 求めた経路は通過する区画の列として返し、走行モードの列は Compiler が
+ * スラロームの前後の直進の短縮を含めて生成する。
+ */
+class Planner {
+ public:
+  using Path = std::vector<Position>;
+
+ private:
+  //! 設定
+  const config::Config &conf_;
+  //! 見積もり走行時間 [s]
+  float time_{0.0f};
+  //! 区画の経路
+  Path path_;
+
+ public:
+  explicit Planner(const config::Config &conf) : conf_(conf) {}
+  ~Planner() = default;
+
+  /**
+   * @brief 速度をv0からv1まで変えながら距離lengthを走行する時間を見積もる
+   * @param length 走行距離 [mm]
+   * @param v0 開始速度 [mm/s]
+   * @param v1 終了速度 [mm/s]
+   * @param param 拘束条件 (最大速度・加速度・躍度)
+   * @return 走行時間 [s]
+   */
+  static float travel_time(float length, float v0, float v1,
+                           const run::Parameter &param);
+
+  /**
+   * @brief スラローム旋回の始点から終点までの走行距離 [mm]
+   */
+  static float turn_length(run::Mode mode);
+
+  /**
+   * @brief スタート区画中央からゴール区画中央までの最小の走行時間を求める
+   * @return 経路が見つかったか
+   */
+  bool plan(const Maze &maze, Position goal, run::Level level);
+
+  /// 経路の見積もり走行時間 [s]
+  [[nodiscard]] float time() const { return time_; }
+  /// スタート区画からゴール区画までの区画の経路 (見つからなければ空)
+  [[nodiscard]] const Path &path() const { return path_; }
+};
+}  // namespace maze
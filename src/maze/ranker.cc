@@ -0,0 +1,150 @@
+#include "ranker.h"
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+// Project
+#include "planner.h"
+
+namespace maze {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+int64_t since_us(Clock::time_point begin) {
+  const auto elapsed = Clock::now() - begin;
+  return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+// 隣接する区画への方角
+Direction direction(Position from, Position to) {
+  for (int i = 0; i < 4; i++) {
+    const auto dir = static_cast<Direction>(i);
+    if (neighbor(from, dir) == to) return dir;
+  }
+  return Direction::North;
+}
+}  // namespace
+
+bool Ranker::evaluate(const Path &path, run::Level level,
+                      Candidate &candidate) {
+  if (!compiler_.compile(path, level)) {
+    return false;
+  }
+  candidate.path = path;
+  candidate.route = compiler_.route();
+  candidate.time = compiler_.time();
+  candidate.turns = static_cast<int>(
+      std::count_if(candidate.route.begin(), candidate.route.end(),
+                    [](const run::Parameter &param) {
+                      return param.mode != run::Mode::Straight &&
+                             param.mode != run::Mode::Diagonal;
+                    }));
+  return true;
+}
+
+bool Ranker::rank(const Maze &maze, Position goal, run::Level level, int k,
+                  int64_t budget_us) {
+  const auto begin = Clock::now();
+  candidates_.clear();
+  truncated_ = false;
+  k = std::clamp(k, 1, MAX_CANDIDATES);
+
+  // Yenの方法: 確定した経路(found)から分岐する経路を候補(pending)に加え、
+  // 歩数が最小の候補を次の確定経路とする
+  std::vector<Path> found;
+  std::vector<Path> pending;
+  auto first = Compiler::path(maze, goal);
+  if (first.empty()) {
+    elapsed_us_ = since_us(begin);
+    return false;
+  }
+  found.push_back(std::move(first));
+  auto blocked = std::make_unique<Maze>(maze);
+  while (static_cast<int>(found.size()) < k) {
+    if (since_us(begin) >= budget_us) {
+      truncated_ = true;
+      break;
+    }
+    const auto &prev = found.back();
+    for (std::size_t i = 0; i + 1 < prev.size(); i++) {
+      *blocked = maze;
+      // 根元が同じ確定経路の次の区画へは進まない
+      for (const auto &p : found) {
+        if (p.size() > i + 1 && std::equal(prev.begin(), prev.begin() + i + 1,
+                                           p.begin())) {
+          blocked->set_wall(p[i], direction(p[i], p[i + 1]), true);
+        }
+      }
+      // 根元の区画は通らない
+      for (std::size_t j = 0; j < i; j++) {
+        for (int d = 0; d < 4; d++) {
+          blocked->set_wall(prev[j], static_cast<Direction>(d), true);
+        }
+      }
+      const auto dir =
+          i == 0 ? Direction::North : direction(prev[i - 1], prev[i]);
+      auto spur = Compiler::path(*blocked, prev[i], dir, goal);
+      if (spur.empty()) {
+        continue;
+      }
+      Path path(prev.begin(), prev.begin() + i);
+      path.insert(path.end(), spur.begin(), spur.end());
+      if (std::find(found.begin(), found.end(), path) == found.end() &&
+          std::find(pending.begin(), pending.end(), path) == pending.end()) {
+        pending.push_back(std::move(path));
+      }
+    }
+    if (pending.empty()) {
+      break;
+    }
+    auto next = std::min_element(
+        pending.begin(), pending.end(),
+        [](const Path &a, const Path &b) { return a.size() < b.size(); });
+    found.push_back(std::move(*next));
+    pending.erase(next);
+  }
+
+  // 走行時間が最小の経路は歩数が多くても候補に加える
+  // (k本を超える場合は歩数の最も多い経路と入れ替える)
+  Planner planner(conf_);
+  if (planner.plan(maze, goal, level) &&
+      std::find(found.begin(), found.end(), planner.path()) == found.end()) {
+    if (static_cast<int>(found.size()) >= k) {
+      found.pop_back();
+    }
+    found.push_back(planner.path());
+  }
+
+  // 走行時間を見積もって順位付けする
+  for (const auto &path : found) {
+    Candidate candidate;
+    if (evaluate(path, level, candidate)) {
+      candidates_.push_back(std::move(candidate));
+    }
+  }
+  if (candidates_.empty()) {
+    elapsed_us_ = since_us(begin);
+    return false;
+  }
+  std::sort(candidates_.begin(), candidates_.end(),
+            [](const Candidate &a, const Candidate &b) {
+              return a.time < b.time;
+            });
+
+  // 旋回の数が最も少ない経路を1つ下の走行レベルで走る
+  const auto safer = std::min_element(
+      candidates_.begin(), candidates_.end(),
+      [](const Candidate &a, const Candidate &b) {
+        return a.turns < b.turns || (a.turns == b.turns && a.time < b.time);
+      });
+  const auto lower = level == run::Level::Fast0
+                         ? level
+                         : static_cast<run::Level>(static_cast<int>(level) - 1);
+  safer_ = *safer;
+  evaluate(safer->path, lower, safer_);
+  elapsed_us_ = since_us(begin);
+  return true;
+}
+}  // namespace maze
@@ -0,0 +1,95 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <vector>
+
+// Project
+#include "compiler.h"
+#include "config.h"
+#include "maze.h"
+#include "run.h"
+
+namespace maze {
+/**
+ * @brief 歩数の少ない順に複数の経路を列挙し、走行時間で順位付けする
+ * @details
+ * 既知の壁のみを通る区画の経路を Yen の方法で歩数の少ない順にk本列挙し、
+ * Planner が走行時間で探索した経路を加えて、
+ * それぞれを Compiler で走行モードの列に変換して走行時間を見積もる。
+ * 歩数が同じでも旋回の数や斜めの有無で走行時間は大きく変わるため、
+ * 走行時間が最小の経路を選ぶ。
+ * また、旋回の数が最も少ない経路を1つ下の走行レベルで変換し、
+ * 失敗した後に走る安全な経路として保持する。
+ * スタート区画で待機する間に計算を終えるため、列挙は計算時間の上限で
+ * 打ち切り、それまでに列挙した経路で順位付けする。
+ */
+class Ranker {
+ public:
+  using Path = Compiler::Path;
+  using Route = Compiler::Route;
+
+  /// 列挙する経路の数の上限
+  static constexpr int MAX_CANDIDATES = 8;
+  /// 列挙を打ち切る計算時間 [us]
+  /// (32x32の迷路でk = MAX_CANDIDATESの列挙がホストで数ms、実機でその数十倍)
+  static constexpr int64_t BUDGET_US = 500'000;
+
+  // 候補の経路
+  struct Candidate {
+    //! 区画の経路
+    Path path;
+    //! 走行モードの列
+    Route route;
+    //! 見積もり走行時間 [s]
+    float time;
+    //! スラローム旋回の数
+    int turns;
+  };
+
+ private:
+  //! 設定
+  const config::Config &conf_;
+  //! 候補の経路 (走行時間の短い順)
+  std::vector<Candidate> candidates_;
+  //! 安全な経路
+  Candidate safer_{};
+  //! 経路を変換する (候補ごとに作り直さない)
+  Compiler compiler_;
+  //! 直前の順位付けの計算時間 [us]
+  int64_t elapsed_us_{0};
+  //! 直前の順位付けで列挙を打ち切ったか
+  bool truncated_{false};
+
+  bool evaluate(const Path &path, run::Level level, Candidate &candidate);
+
+ public:
+  explicit Ranker(const config::Config &conf) : conf_(conf), compiler_(conf) {}
+  ~Ranker() = default;
+
+  /**
+   * @brief 候補の経路を列挙して順位付けする
+   * @param level 最も速い経路を走る走行レベル
+   * @param k 列挙する経路の数 (MAX_CANDIDATES以下)
+   * @param budget_us 列挙を打ち切る計算時間 [us]
+   * @return 経路が見つかったか
+   */
+  bool rank(const Maze &maze, Position goal, run::Level level,
+            int k = MAX_CANDIDATES, int64_t budget_us = BUDGET_US);
+
+  /// 候補の経路 (走行時間の短い順)
+  [[nodiscard]] const std::vector<Candidate> &candidates() const {
+    return candidates_;
+  }
+  /// 走行時間が最小の経路
+  [[nodiscard]] const Candidate &fastest() const {
+    return candidates_.front();
+  }
+  /// 1つ下の走行レベルで走る、旋回の数が最も少ない経路
+  [[nodiscard]] const Candidate &safer() const { return safer_; }
+  /// 直前の順位付けの計算時間 [us]
+  [[nodiscard]] int64_t elapsed_us() const { return elapsed_us_; }
+  /// 直前の順位付けで計算時間の上限により列挙を打ち切ったか
+  [[nodiscard]] bool truncated() const { return truncated_; }
+};
+}  // namespace maze
@@ -0,0 +1,124 @@
+#include "simulator.h"
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+
+// Project
+#include "adachi.h"
+#include "flood.h"
+#include "planner.h"
+#include "run.h"
+
+namespace maze {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+float elapsed_us(Clock::time_point begin) {
+  return std::chrono::duration<float, std::micro>(Clock::now() - begin)
+      .count();
+}
+}  // namespace
+
+Simulator::Result Simulator::run(const Maze &truth, Position goal) {
+  Result result{};
+  Adachi adachi({truth.width(), truth.height()}, goal);
+
+  // 探索の走行時間の見積もりに用いる拘束条件
+  const auto straight =
+      run::parameter(conf_, run::Mode::Straight, run::Level::Search);
+  auto pivot = run::parameter(conf_, run::Mode::PivotTurn, run::Level::Search);
+  pivot.max_velocity = pivot.max_angular_velocity;
+  pivot.max_acceleration = pivot.max_angular_acceleration;
+  pivot.max_jerk = pivot.max_angular_jerk;
+  const auto velocity = straight.max_velocity;
+  const auto half = CELL_SIZE / 2.0f;
+  // 区画境界から区画境界までの走行時間
+  const auto straight_time = CELL_SIZE / velocity;
+  const auto slalom_time = std::numbers::pi_v<float> * half / 2.0f / velocity;
+  const auto back_time =
+      Planner::travel_time(half, velocity, 0.0f, straight) +
+      Planner::travel_time(std::numbers::pi_v<float>, 0.0f, 0.0f, pivot) +
+      Planner::travel_time(half, 0.0f, velocity, straight);
+  const auto stop_time = Planner::travel_time(half, velocity, 0.0f, straight);
+
+  result.search_time = Planner::travel_time(half, 0.0f, velocity, straight);
+  const int limit = truth.width() * truth.height() * 4;
+  float decision_total = 0.0f;
+  for (int i = 0; i < limit; i++) {
+    // 次に進入する区画の壁を読む
+    const auto pos = adachi.position();
+    const auto dir = adachi.direction();
+    const auto begin = Clock::now();
+    adachi.update(truth.is_wall(pos, dir),
+                  truth.is_wall(pos, rotate(dir, -1)),
+                  truth.is_wall(pos, rotate(dir, 1)));
+    const auto turn = adachi.finished() ? std::nullopt : adachi.next();
+    const auto us = elapsed_us(begin);
+    result.trace.push_back(pos);
+    decision_total += us;
+    result.max_decision_us = std::max(result.max_decision_us, us);
+    result.cells++;
+
+    if (!result.reached && adachi.phase() != Phase::Goal) {
+      result.reached = true;
+      result.goal_cells = result.cells;
+      result.goal_time = result.search_time + stop_time;
+    }
+    if (adachi.finished()) {
+      result.finished = true;
+      result.search_time += stop_time;
+      break;
+    }
+    if (!turn.has_value()) {
+      break;
+    }
+    switch (*turn) {
+      case Turn::Straight:
+        result.search_time += straight_time;
+        break;
+      case Turn::Left:
+      case Turn::Right:
+        result.search_time += slalom_time;
+        break;
+      case Turn::Back:
+        result.search_time += back_time;
+        break;
+    }
+    adachi.advance(*turn);
+  }
+  result.decision_us = decision_total / static_cast<float>(result.cells);
+  result.proven = adachi.candidates().proven();
+
+  // 探索で得た迷路と正解の迷路での最短歩数
+  Flood known;
+  known.update(adachi.maze(), Flood::cells({goal}), Flood::Unknown::Wall);
+  Flood optimal;
+  optimal.update(truth, Flood::cells({goal}), Flood::Unknown::Wall);
+  result.known_length = known.distance(Adachi::START);
+  result.optimal_length = optimal.distance(Adachi::START);
+
+  for (int y = 0; y < truth.height(); y++) {
+    for (int x = 0; x < truth.width(); x++) {
+      if (adachi.maze().is_visited(
+              {static_cast<int8_t>(x), static_cast<int8_t>(y)})) {
+        result.visited++;
+      }
+    }
+  }
+
+  // 探索で得た迷路で最短経路を求める
+  Planner planner(conf_);
+  const auto begin = Clock::now();
+  for (std::size_t i = 0; i < result.fast_time.size(); i++) {
+    const auto level = static_cast<run::Level>(
+        static_cast<std::size_t>(run::Level::Fast0) + i);
+    result.fast_time[i] =
+        planner.plan(adachi.maze(), goal, level) ? planner.time() : INFINITY;
+  }
+  result.planning_us = elapsed_us(begin);
+  return result;
+}
+}  // namespace maze
@@ -0,0 +1,69 @@
+#pragma once
+
+// C++
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Project
+#include "config.h"
+#include "maze.h"
+
+namespace maze {
+/**
+ * @brief 既知の迷路で探索と最短経路計算を模擬する
+ * @details
+ * 区画ごとに正解の迷路から壁を読み取って maze::Adachi に与え、
+ * ゴールへの探索、最短経路が確定するまでの追加探索、スタートへの帰還を
+ * 走行なしで模擬する。
+ * 探索で得た迷路から走行レベルごとに maze::Planner で最短の走行時間を求める。
+ */
+class Simulator {
+ public:
+  // 模擬結果
+  struct Result {
+    //! ゴールに到達したか
+    bool reached;
+    //! スタートに戻ったか
+    bool finished;
+    //! 最短経路が確定したか
+    bool proven;
+    //! ゴール到達までに走行した区画数
+    int goal_cells;
+    //! スタートに戻るまでに走行した区画数
+    int cells;
+    //! 四方の壁を観測した区画数
+    int visited;
+    //! 探索で得た迷路での最短歩数・正解の迷路での最短歩数
+    int known_length;
+    int optimal_length;
+    //! ゴール到達までの見積もり探索時間 [s]
+    float goal_time;
+    //! スタートに戻るまでの見積もり探索時間 [s]
+    float search_time;
+    //! 最短走行の見積もり時間 (Fast0 ~ Fast4) [s]
+    std::array<float, 5> fast_time;
+    //! 1区画あたりの判断のCPU時間 (平均・最大) [us]
+    float decision_us;
+    float max_decision_us;
+    //! 最短経路の計算のCPU時間 (Fast0 ~ Fast4の合計) [us]
+    float planning_us;
+    //! 壁を読んだ区画 (読んだ順)
+    std::vector<Position> trace;
+  };
+
+ private:
+  //! 設定
+  const config::Config &conf_;
+
+ public:
+  explicit Simulator(const config::Config &conf) : conf_(conf) {}
+  ~Simulator() = default;
+
+  /**
+   * @brief 正解の迷路でスタートからゴールまで探索し、スタートへ戻る
+   * @param truth 全ての壁が観測済みの迷路
+   */
+  Result run(const Maze &truth, Position goal);
+};
+}  // namespace maze
@@ -0,0 +1,216 @@
+#pragma once
+
+// C++
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <utility>
+
+// Project
+#include "config.h"
+#include "data/pid.h"
+#include "run.h"
+
+namespace motion {
+/**
+ * 参考:
+ * 車体モデル
+ * https://rt-net.jp/mobility/archives/16525
+ * https://rt-net.jp/mobility/archives/12621
+ *
+ * DCモータを使ったマイクロマウス入門シリーズ
+ * https://www.rt-shop.jp/blog/archives/2387
+ *
+ * MK06-4.5特性
+ * http://hidejrlab.blog104.fc2.com/blog-entry-1234.html
+ * http://hidejrlab.blog104.fc2.com/blog-entry-1233.html
+ *
+ * 車体の運動方程式とモータの電圧方程式から目標値を実現する電圧を求め
+ * (フィードフォワード)、測定値との偏差による電圧をPID制御で加える
+ * (フィードバック)。
+ * 並進の力 m·a と回転のトルク I·α を左右の車輪に配分し、
+ * 車輪の力をギアを介してモータのトルク・電流に換算して
+ * 巻線抵抗での電圧降下とし、車輪の速度から求めた逆起電圧を加える。
+ * 動摩擦は車輪の回転を妨げる一定のトルクとして電流に加える。
+ * インダクタンスの時定数 (L/R = 6us) は制御周期より十分短いため無視する。
+ * 角速度は左旋回を正とし、右の車輪が速い向きとする。
+ * PIDゲインは走行レベルごとに切り替え、出力は電池電圧で飽和させる。
+ * 飽和する場合は角速度を優先し、残りの電圧で速度を制御する。
+ */
+class Model {
+ public:
+  /// 制御周期 [s]
+  static constexpr float PERIOD = 0.001f;
+  /// 逆起電圧定数
+  static constexpr float MOTOR_BACK_EMF = 0.062f / 1000.0f;  // [V/rpm]
+  /// インダクタンス
+  static constexpr float MOTOR_INDUCTANCE = 29.1f / 1000'000.0f;  // [H]
+  /// 抵抗
+  static constexpr float MOTOR_RESISTANCE = 5.0f;  // [ohm]
+  /// トルク定数
+  static constexpr float MOTOR_TORQUE = 0.59f / 1000.0f;  // [Nm/A]
+  /// 機械的抵抗 (左右、モータ軸換算の動摩擦トルク、無負荷電流10mA相当)
+  static constexpr float WHEEL_MECHANICAL_RESISTANCE[2] = {
+      MOTOR_TORQUE * 0.01f, MOTOR_TORQUE * 0.01f};  // [Nm]
+  /// ギア比
+  static constexpr float WHEEL_GEAR_RATIO = 38.0f / 9.0f;  // 1:n
+  /// 車体質量
+  static constexpr float WEIGHT = 10.0f / 1000.0f;  // [kg]
+  /// 車体の慣性モーメント (30mm×40mmの一様な板として近似)
+  static constexpr float INERTIA = 2.0f / 1000'000.0f;  // [kg m^2]
+  /// 逆起電圧定数 (モータの角速度あたり)
+  static constexpr float BACK_EMF =
+      MOTOR_BACK_EMF * 60.0f / (2.0f * std::numbers::pi_v<float>);  // [V s/rad]
+
+ private:
+  /// 動摩擦を加える車輪の最小速度 [m/s]
+  static constexpr float FRICTION_THRESHOLD = 0.001f;
+  /// 微分の1次フィルタの時定数 [s]
+  static constexpr float DERIVATIVE_FILTER = 0.005f;
+
+  /// 設定
+  config::Config &conf_;
+  /// ゲインを設定した走行レベル
+  run::Level level_{run::Level::Search};
+  /// 速度PID制御
+  data::Pid<float> velo_pid_{
+      gain(conf_.velocity_pid, conf_.fast_velocity_pid, level_), PERIOD,
+      DERIVATIVE_FILTER};
+  /// 角速度PID制御
+  data::Pid<float> ang_velo_pid_{gain(conf_.angular_velocity_pid,
+                                      conf_.fast_angular_velocity_pid, level_),
+                                 PERIOD, DERIVATIVE_FILTER};
+
+  /**
+   * @brief 走行レベルのPIDゲイン
+   * @param search 探索走行のゲイン
+   * @param fast 最短走行のゲイン (Fast0 ~ Fast4 の kp, ki, kd を順に並べる)
+   */
+  static data::Pid<float>::Gain gain(const std::array<float, 3> &search,
+                                     const std::array<float, 15> &fast,
+                                     run::Level level) {
+    if (level == run::Level::Search) {
+      return {search[0], search[1], search[2]};
+    }
+    const auto i = 3 * (static_cast<std::size_t>(level) -
+                        static_cast<std::size_t>(run::Level::Fast0));
+    return {fast[i], fast[i + 1], fast[i + 2]};
+  }
+
+  /**
+   * @brief 走行レベルが変わったらPIDゲインを切り替える
+   */
+  void schedule(run::Level level) {
+    if (level == level_) {
+      return;
+    }
+    level_ = level;
+    velo_pid_.gain(gain(conf_.velocity_pid, conf_.fast_velocity_pid, level_));
+    ang_velo_pid_.gain(gain(conf_.angular_velocity_pid,
+                            conf_.fast_angular_velocity_pid, level_));
+  }
+
+ public:
+  explicit Model(config::Config &conf) : conf_(conf) {}
+  ~Model() = default;
+
+  /**
+   * リセット
+   */
+  void reset() {
+    velo_pid_.reset();
+    ang_velo_pid_.reset();
+  }
+
+  /**
+   * 制御周期の変更
+   * @param period 制御周期 [s] (PIDを更新する周期)
+   */
+  void period(float period) {
+    velo_pid_.period(period);
+    ang_velo_pid_.period(period);
+  }
+
+  /**
+   * フィードフォワード制御
+   * @param target 目標値
+   * @return 左右のモーター電圧 [V]
+   */
+  [[nodiscard]] std::pair<float, float> feedforward(
+      const run::Target &target) const {
+    // [mm] -> [m]
+    const auto tire_rad = (conf_.tire_diameter / 2.0f) / 1000.0f;
+    const auto track = conf_.wheel_track_width / 1000.0f;
+    // [mm/s], [mm/s^2] -> [m/s], [m/s^2]
+    const auto velo = target.velocity / 1000.0f;
+    const auto accel = target.acceleration / 1000.0f;
+
+    // 車輪の接地点の力 [N]
+    const auto force_velo = WEIGHT * accel / 2.0f;
+    const auto force_ang = INERTIA * target.angular_acceleration / track;
+    // 車輪の速度 [m/s]
+    const auto velo_ang = target.angular_velocity * track / 2.0f;
+
+    auto voltage = [&](float force, float wheel_velo, float friction) {
+      // 車輪の力をモータのトルク・電流に換算する
+      auto torque = force * tire_rad / WHEEL_GEAR_RATIO;
+      if (std::abs(wheel_velo) > FRICTION_THRESHOLD) {
+        torque += std::copysign(friction, wheel_velo);
+      }
+      const auto current = torque / MOTOR_TORQUE;
+      // 巻線抵抗での電圧降下と逆起電圧
+      const auto motor_ang_velo = wheel_velo / tire_rad * WHEEL_GEAR_RATIO;
+      return MOTOR_RESISTANCE * current + BACK_EMF * motor_ang_velo;
+    };
+    return {voltage(force_velo - force_ang, velo - velo_ang,
+                    WHEEL_MECHANICAL_RESISTANCE[0]),
+            voltage(force_velo + force_ang, velo + velo_ang,
+                    WHEEL_MECHANICAL_RESISTANCE[1])};
+  }
+
+  /**
+   * フィードバック制御
+   * @param target 目標値
+   * @param velocity 測定した速度 [mm/s]
+   * @param angular_velocity 測定した角速度 [rad/s]
+   * @param feedforward 左右のフィードフォワードの電圧 [V]
+   * @param battery 電池電圧 [V]
+   * @return フィードフォワードを含めて飽和させた左右のモーター電圧 [V]
+   */
+  std::pair<float, float> feedback(const run::Target &target, float velocity,
+                                   float angular_velocity,
+                                   const std::pair<float, float> &feedforward,
+                                   float battery) {
+    schedule(target.parameter.level);
+    const auto [ff_left, ff_right] = feedforward;
+    // 角速度フィードバック (左右の差の半分)
+    const auto ang_velo_u = ang_velo_pid_.update(
+        target.angular_velocity, angular_velocity,
+        (ff_right - ff_left) * 0.5f, -battery, battery);
+    // 速度フィードバック (左右の和の半分、角速度の残りの電圧で飽和させる)
+    const auto headroom = battery - std::abs(ang_velo_u);
+    const auto velo_u = velo_pid_.update(
+        target.velocity / 1000.0f, velocity / 1000.0f,  // [mm/s] -> [m/s]
+        (ff_left + ff_right) * 0.5f, -headroom, headroom);
+    return {velo_u - ang_velo_u, velo_u + ang_velo_u};
+  }
+
+  /**
+   * フィードフォワード・フィードバック制御
+   * @param target 目標値
+   * @param velocity 測定した速度 [mm/s]
+   * @param angular_velocity 測定した角速度 [rad/s]
+   * @param battery_voltage 電池電圧 [mV]
+   * @return 左右のモーター電圧 [mV]
+   */
+  std::pair<int, int> update(const run::Target &target, float velocity,
+                             float angular_velocity, int battery_voltage) {
+    const auto [left, right] =
+        feedback(target, velocity, angular_velocity, feedforward(target),
+                 static_cast<float>(battery_voltage) / 1000.0f);
+    return {static_cast<int>(std::lround(left * 1000.0f)),
+            static_cast<int>(std::lround(right * 1000.0f))};
+  }
+};
+}  // namespace motion
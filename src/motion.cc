@@ -1,118 +1,92 @@
 #include "motion.h"
 
 // C++
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 
 // ESP-IDF
 #include <esp_system.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 
 // Project
 #include "config.h"
-#include "data/pid.h"
 #include "driver/driver.h"
+#include "model.h"
 #include "odometry.h"
 #include "rtos/queue.h"
-#include "rtos/task.h"
+#include "rtos/timer_task.h"
 #include "run.h"
+#include "sensor.h"
+#include "tracker.h"
+#include "trajectory.h"
 
 namespace motion {
 /**
- * 参考:
- * 車体モデル
- * https://rt-net.jp/mobility/archives/16525
- * https://rt-net.jp/mobility/archives/12621
- *
- * DCモータを使ったマイクロマウス入門シリーズ
- * https://www.rt-shop.jp/blog/archives/2387
- *
- * MK06-4.5特性
- * http://hidejrlab.blog104.fc2.com/blog-entry-1234.html
- * http://hidejrlab.blog104.fc2.com/blog-entry-1233.html
+ * 目標値は run::Run・焼き込んだ軌道の制御周期 (1ms) ごとに生成し、
+ * 速度・角速度の制御は config::Config::control_frequency の周期で行う。
+ * 周波数を上げた場合、次の目標値までの間は同じ目標値を測定値と比べ直す。
+ * 制御周期は sensor::Sensor がオドメトリを更新するたびに起こされて刻み、
+ * センサ値の取得開始から両モータの出力を終えるまでの時間を記録する。
  */
-class Model {
+class Motion::MotionImpl final : public rtos::TimerTask {
  private:
-  /// 逆起電圧定数
-  static constexpr float MOTOR_BACK_EMF = 0.062f / 1000.0f;  // [V/rpm]
-  /// インダクタンス
-  static constexpr float MOTOR_INDUCTANCE = 29.1f / 1000'000.0f;  // [H]
-  /// 抵抗
-  static constexpr float MOTOR_RESISTANCE = 5.0f;  // [ohm]
-  /// トルク定数
-  static constexpr float MOTOR_TORQUE = 0.59f / 1000.0f;  // [Nm/A]
-  /// 機械的抵抗 (左右)
-  static constexpr float WHEEL_MECHANICAL_RESISTANCE[2] = {0.0f, 0.0f};
-  /// ギア比
-  static constexpr float WHEEL_GEAR_RATIO = 38.0f / 9.0f;  // 1:n
-  /// 車体質量
-  static constexpr float WEIGHT = 10.0f / 1000.0f;  // [kg]
-
-  /// 設定
-  config::Config &conf_;
-  /// オドメトリ
-  odometry::Odometry &odom_;
-  /// 速度PID制御
-  data::Pid velo_pid_{conf_.velocity_pid[0], conf_.velocity_pid[1],
-                      conf_.velocity_pid[2]};
-  /// 角速度PID制御
-  data::Pid ang_velo_pid_{conf_.angular_velocity_pid[0],
-                          conf_.angular_velocity_pid[1],
-                          conf_.angular_velocity_pid[2]};
-
- public:
-  explicit Model(config::Config &conf, odometry::Odometry &odom)
-      : conf_(conf), odom_(odom) {}
-  ~Model() = default;
-
-  /**
-   * リセット
-   */
-  void reset() {
-    velo_pid_.reset();
-    ang_velo_pid_.reset();
-  }
-
-  /**
-   * フィードフォワード・フィードバック制御
-   * @param target 目標値
-   * @return 左右のモーター電圧[mV]
-   */
-  std::pair<int, int> update(const run::Target &target) {
-    // 速度フィードバック
-    const auto &velo_wheels = odom_.wheels_velocity();
-    auto velo_left = velo_wheels.left / 1000.f;     // [mm/s] -> [m/s]
-    auto velo_right = velo_wheels.right / 1000.0f;  // [mm/s] -> [m/s]
-    auto velo = (velo_left + velo_right) / 2.0f;
-    auto velo_target = target.velocity / 1000.0f;  // [mm/s] -> [m/s]
-    auto velo_err = velo_pid_.update(velo_target, velo, 1.0f);
-
-    // 角速度フィードバック
-    auto ang_velo = target.angular_velocity;
-    auto ang_velo_target = odom_.velocity();
-    auto ang_velo_err = ang_velo_pid_.update(ang_velo, ang_velo_target, 1.0f);
-
-    // フィードフォワード
-    auto tire_rad = (conf_.tire_diameter / 2.0f) / 1000.0f;  // [mm] -> [m]
-    auto tire_rad_div = tire_rad / 2.0f;
-    auto tire_tread = conf_.tire_tread_width / 1000.0f;  // [mm] -> [m]
-    auto tire_tread_div = tire_rad / tire_tread;
-
-    return {0, 0};
-  }
-};
+  /// 目標値を生成する周波数 [Hz]
+  static constexpr uint32_t TARGET_FREQUENCY = 1000;
 
-class Motion::MotionImpl final : public rtos::Task {
- private:
   driver::Driver &dri_;
   config::Config &conf_;
+  odometry::Odometry &odom_;
   /// モデル
   Model model_;
-  /// 走行モードを受け取るキュー
+  /// 軌道追従制御
+  Tracker tracker_;
+  /// 走行モードのキューの長さ
+  static constexpr UBaseType_t QUEUE_LENGTH = 32;
+
+  /// 走行モードを順に受け取るキュー
   rtos::Queue<run::Parameter> queue_;
+  /// 走行中の走行モードを中断して受け取るキュー
+  rtos::Queue<run::Parameter> interrupt_;
+  /// 完了した走行モードの通知
+  rtos::Queue<Progress> completed_;
+  /// 現在の走行モードの進捗
+  rtos::Queue<Progress> progress_;
+  /// 再生する軌道を受け取るキュー
+  rtos::Queue<const trajectory::Trajectory *> stream_;
   /// 目標値
   run::Parameter parameter{};
   /// 走行目標値生成クラス
   run::Run run_;
+  /// 走行モードの開始時の車体角度 [rad]
+  float start_angle_{0.0f};
+  /// 走行モードの開始時の走行距離 [mm]
+  float start_length_{0.0f};
+  /// 走行モードが目標値を出している途中か
+  bool active_{false};
+  /// 走行モードの通し番号
+  uint32_t sequence_{0};
+  /// 前の周期で走行モードが速度を持ったまま終了したか (次を続けて開始できる)
+  bool chainable_{false};
+  /// 直前の目標速度・目標距離 [mm/s], [mm]
+  float velocity_{0.0f};
+  float length_{0.0f};
+  /// 再生中の軌道 (再生していなければnullptr)
+  const trajectory::Trajectory *trajectory_{nullptr};
+  /// 再生中の制御周期・走行モードの添字
+  std::size_t index_{0};
+  std::size_t segment_{0};
+  /// 軌道から読み出した目標値
+  run::Target streamed_{};
+  /// 制御周期あたりの目標値の生成周期の数・その中の位置
+  uint32_t divider_{1};
+  uint32_t phase_{0};
+  /// 制御に使う目標値 (姿勢の補正後)
+  const run::Target *command_{nullptr};
+  /// センサ値の取得開始からモータ出力までの遅延の合計 [us]・統計
+  int64_t latency_sum_{0};
+  Latency latency_{};
 
   // 緊急停止
   void emergency_stop() {
@@ -132,8 +106,161 @@ class Motion::MotionImpl final : public rtos::Task {
     }
   }
 
+  /**
+   * @brief 走行モードを開始する
+   * @param chained 前の走行モードから速度を引き継ぐか
+   * @details
+   * 引き継ぐ場合、走行距離は前の走行モードの目標距離の終点から数え、
+   * 車体の遅れが走行モードの境界で失われないようにする。
+   * 引き継がない場合も走行中であれば、モデルと姿勢の追従の状態は残す。
+   */
+  void begin(const run::Parameter &param, bool chained) {
+    parameter = param;
+    if (chained) {
+      if (param.mode == run::Mode::Straight ||
+          param.mode == run::Mode::Diagonal) {
+        parameter.start_velocity = velocity_;
+      }
+      start_length_ += length_;
+    } else {
+      // 停止から始める場合のみ、積分と姿勢の偏差を捨てる
+      if (std::abs(velocity_) <= 0.0f && param.start_velocity <= 0.0f) {
+        model_.reset();
+        tracker_.reset(odom_.x(), odom_.y(), odom_.angle());
+      }
+      start_length_ = odom_.length();
+    }
+    run_.reset();
+    start_angle_ = odom_.angle();
+    active_ = true;
+    sequence_++;
+  }
+
+  /**
+   * @brief 軌道の走行モードを開始する
+   */
+  void begin_segment() {
+    streamed_.length = 0.0f;
+    streamed_.angle = 0.0f;
+    active_ = true;
+    sequence_++;
+  }
+
+  /**
+   * @brief 軌道の再生を終えて停止する
+   */
+  void finish_stream() {
+    trajectory_ = nullptr;
+    parameter = run::Parameter{};
+    run_.reset();
+  }
+
+  /**
+   * @brief 走行モードを切り替え、次の目標値を生成する
+   */
+  void generate() {
+    // 中断する走行モード・軌道、または前の走行モードの終了後に次を取得
+    run::Parameter next;
+    const trajectory::Trajectory *trajectory;
+    if (interrupt_.receive(&next, 0)) {
+      queue_.reset();
+      trajectory_ = nullptr;
+      begin(next, false);
+    } else if (stream_.receive(&trajectory, 0)) {
+      queue_.reset();
+      model_.reset();
+      tracker_.reset(odom_.x(), odom_.y(), odom_.angle());
+      trajectory_ = trajectory;
+      streamed_.parameter = run::Parameter{};
+      streamed_.parameter.level = trajectory_->level();
+      index_ = 0;
+      segment_ = 0;
+      if (trajectory_->segments() > 0) {
+        begin_segment();
+      } else {
+        finish_stream();
+      }
+    } else if (!active_ && trajectory_ == nullptr &&
+               queue_.receive(&next, 0)) {
+      begin(next, chainable_);
+    }
+    chainable_ = false;
+    // 軌道を読み出すか、走行パターンから目標値を生成
+    const run::Target *target;
+    bool finished;
+    if (trajectory_ != nullptr) {
+      trajectory_->at(index_, streamed_);
+      streamed_.length += streamed_.velocity * trajectory::Trajectory::PERIOD;
+      streamed_.angle +=
+          streamed_.angular_velocity * trajectory::Trajectory::PERIOD;
+      index_++;
+      finished = index_ >= trajectory_->end(segment_);
+      target = &streamed_;
+    } else {
+      run_.measure(odom_.length() - start_length_,
+                   odom_.angle() - start_angle_);
+      target = &run_.run(parameter);
+      finished = run_.finished();
+      if (!run_.feasible()) {
+        // 終了速度まで加減速しきれない直進は走らず、キューを破棄して停止する
+        // (完了は通知せず、待っている側はタイムアウトで中止を知る)
+        queue_.reset();
+        parameter = run::Parameter{};
+        parameter.mode = run::Mode::Stop;
+        run_.reset();
+        target = &run_.run(parameter);
+        active_ = false;
+        finished = false;
+      }
+    }
+    velocity_ = target->velocity;
+    length_ = target->length;
+    Progress state{sequence_, !active_, target->length, target->angle};
+    if (active_ && finished) {
+      active_ = false;
+      // 停止せずに終えた場合のみ、次の周期に開始する走行モードへ引き継ぐ
+      chainable_ = trajectory_ == nullptr && std::abs(target->velocity) > 0.0f;
+      state.completed = true;
+      completed_.send(&state, 0);
+      // 軌道は次の走行モードへ進み、最後まで再生したら停止する
+      if (trajectory_ != nullptr) {
+        if (++segment_ < trajectory_->segments()) {
+          begin_segment();
+        } else {
+          finish_stream();
+        }
+      }
+    }
+    progress_.overwrite(&state);
+
+    // 姿勢の偏差で目標値を補正
+    command_ = conf_.track_pose != 0
+                   ? &tracker_.track(*target, odom_.x(), odom_.y(),
+                                     odom_.angle())
+                   : target;
+  }
+
   void setup() override {
     queue_.reset();
+    interrupt_.reset();
+    completed_.reset();
+    stream_.reset();
+    trajectory_ = nullptr;
+    active_ = false;
+    sequence_ = 0;
+    chainable_ = false;
+    start_length_ = 0.0f;
+    velocity_ = 0.0f;
+    length_ = 0.0f;
+    // 1kHzの倍数 (1kHz ~ 4kHz) に丸める
+    divider_ = static_cast<uint32_t>(
+        std::clamp(conf_.control_frequency / 1000, 1, 4));
+    phase_ = 0;
+    frequency(TARGET_FREQUENCY * divider_);
+    model_.period(1.0f / static_cast<float>(frequency()));
+    model_.reset();
+    latency_sum_ = 0;
+    latency_ = {};
     dri_.motor_left->enable();
     dri_.motor_right->enable();
   }
@@ -142,20 +269,29 @@ class Motion::MotionImpl final : public rtos::Task {
     if (conf_.low_voltage > dri_.battery->average()) {
       emergency_stop();
     }
-    // キューから最新の走行モードを取得
-    if (queue_.receive(&parameter, 0)) {
-      model_.reset();
+    // 目標値は1msごとに生成する
+    if (phase_ == 0) {
+      generate();
     }
-    // 走行パターンから目標値を生成
-    const auto &target = run_.run(parameter);
+    phase_ = (phase_ + 1) % divider_;
 
-    // 目標値から電圧値に変換
-    auto [voltage_left, voltage_right] = model_.update(target);
+    // 電圧値に変換
+    auto battery_voltage = dri_.battery->voltage();
+    auto [voltage_left, voltage_right] =
+        model_.update(*command_, odom_.velocity(), odom_.angular_velocity(),
+                      battery_voltage);
 
     // 反映
-    auto battery_voltage = dri_.battery->voltage();
     dri_.motor_left->speed(voltage_left, battery_voltage);
     dri_.motor_right->speed(voltage_right, battery_voltage);
+
+    // センサ値の取得開始からの遅延
+    const auto latency = esp_timer_get_time() - odom_.sampled_us();
+    latency_sum_ += latency;
+    latency_.samples++;
+    latency_.mean = static_cast<float>(latency_sum_) /
+                    static_cast<float>(latency_.samples);
+    latency_.max = std::max(latency_.max, static_cast<float>(latency));
   }
   void end() override {
     dri_.motor_left->speed(0, dri_.battery->voltage());
@@ -166,20 +302,44 @@ class Motion::MotionImpl final : public rtos::Task {
 
  public:
   explicit MotionImpl(driver::Driver &dri, config::Config &conf,
-                      odometry::Odometry &odom)
-      : rtos::Task(__func__, pdMS_TO_TICKS(1)),
+                      odometry::Odometry &odom, sensor::Sensor &sens)
+      : rtos::TimerTask(__func__, TARGET_FREQUENCY),
         dri_(dri),
         conf_(conf),
-        model_(conf, odom),
-        queue_(1) {}
+        odom_(odom),
+        model_(conf),
+        tracker_(conf),
+        queue_(QUEUE_LENGTH),
+        interrupt_(1),
+        completed_(QUEUE_LENGTH),
+        progress_(1),
+        stream_(1) {
+    follow(sens.task());
+  }
   ~MotionImpl() override = default;
 
-  bool set(run::Parameter *param) { return queue_.overwrite(param); }
+  bool set(run::Parameter *param) { return interrupt_.overwrite(param); }
+  bool push(const run::Parameter *param, TickType_t ticks_to_wait) {
+    return queue_.send(param, ticks_to_wait);
+  }
+  bool stream(const trajectory::Trajectory *trajectory) {
+    return stream_.overwrite(&trajectory);
+  }
+  bool wait(Progress *progress, TickType_t ticks_to_wait) {
+    return completed_.receive(progress, ticks_to_wait);
+  }
+  Progress progress() {
+    Progress ret{};
+    progress_.peek(&ret, 0);
+    return ret;
+  }
+  uint32_t pending() { return queue_.waiting(); }
+  Latency latency() { return latency_; }
 };
 
 Motion::Motion(driver::Driver &dri, config::Config &conf,
-               odometry::Odometry &odom)
-    : impl_(new MotionImpl(dri, conf, odom)) {}
+               odometry::Odometry &odom, sensor::Sensor &sens)
+    : impl_(new MotionImpl(dri, conf, odom, sens)) {}
 Motion::~Motion() = default;
 
 bool Motion::start(uint32_t usStackDepth, UBaseType_t uxPriority,
@@ -187,5 +347,19 @@ bool Motion::start(uint32_t usStackDepth, UBaseType_t uxPriority,
   return impl_->start(usStackDepth, uxPriority, xCoreID);
 }
 bool Motion::stop() { return impl_->stop(); }
+bool Motion::set(run::Parameter &param) { return impl_->set(&param); }
+bool Motion::push(const run::Parameter &param, TickType_t ticks_to_wait) {
+  return impl_->push(&param, ticks_to_wait);
+}
+bool Motion::wait(Progress &progress, TickType_t ticks_to_wait) {
+  return impl_->wait(&progress, ticks_to_wait);
+}
+bool Motion::stream(const trajectory::Trajectory &trajectory) {
+  return impl_->stream(&trajectory);
+}
+Progress Motion::progress() { return impl_->progress(); }
+uint32_t Motion::pending() { return impl_->pending(); }
 uint32_t Motion::delta_us() { return impl_->delta_us(); };
+rtos::TimerTask::Jitter Motion::jitter() { return impl_->jitter(); }
+Latency Motion::latency() { return impl_->latency(); }
 }  // namespace motion
@@ -7,22 +7,99 @@
 #include "config.h"
 #include "driver/driver.h"
 #include "odometry.h"
+#include "rtos/timer_task.h"
+#include "run.h"
+#include "sensor.h"
+#include "trajectory.h"
 
 namespace motion {
 enum class Message { EmergencyStop, Running, Waiting };
 
+// 走行モードの進捗
+struct Progress {
+  /// 走行モードの通し番号 (開始した順に1から)
+  uint32_t sequence;
+  /// 目標値を出し終えたか
+  bool completed;
+  /// 走行モードの開始からの目標距離 [mm]
+  float length;
+  /// 走行モードの開始からの目標角度 [rad]
+  float angle;
+};
+
+// センサ値の取得開始からモータ出力までの遅延の統計
+struct Latency {
+  /// 計測した制御周期の数
+  uint32_t samples;
+  /// 平均・最大 [us]
+  float mean;
+  float max;
+};
+
 class Motion {
  private:
   class MotionImpl;
   std::shared_ptr<MotionImpl> impl_;
 
  public:
+  /**
+   * @param sens 制御周期ごとに起こすセンサ取得 (先に開始し、後に停止する)
+   */
   explicit Motion(driver::Driver &dri, config::Config &conf,
-                  odometry::Odometry &odom);
+                  odometry::Odometry &odom, sensor::Sensor &sens);
   ~Motion();
 
   uint32_t delta_us();
+  /**
+   * @brief 制御周期のばらつきの統計 (開始から)
+   */
+  rtos::TimerTask::Jitter jitter();
+  /**
+   * @brief センサ値の取得開始からモータ出力までの遅延の統計 (開始から)
+   */
+  Latency latency();
   bool start(uint32_t usStackDepth, UBaseType_t uxPriority, BaseType_t xCoreID);
   bool stop();
+  /**
+   * @brief 走行中の走行モードを中断し、キューを空にして直ちに切り替える
+   */
+  bool set(run::Parameter &param);
+  /**
+   * @brief 走行モードをキューの末尾に追加する
+   * @details
+   * 前の走行モードが目標値を出し終えた次の制御周期で開始する。
+   * 前の走行モードが速度を持ったまま終えた直後に開始する場合は、
+   * 直進・斜め直進の開始速度を前の走行モードの終了時の目標速度とし、
+   * 走行モードの間で停止しない。それ以外 (停止して終えた、
+   * 終えた時点でキューが空だった) は静止状態から新たに開始する。
+   * 引き継いだ速度から終了速度まで加減速しきれない直進・斜め直進は
+   * 走らずにキューを破棄して停止し、完了を通知しない。
+   * @param ticks_to_wait キューが一杯の場合に待つ時間
+   */
+  bool push(const run::Parameter &param,
+            TickType_t ticks_to_wait = portMAX_DELAY);
+  /**
+   * @brief 焼き込んだ軌道を先頭から再生する
+   * @details
+   * 走行中の走行モードとキューを破棄して直ちに切り替え、
+   * 制御周期ごとに目標値を読み出す。
+   * 軌道の走行モードごとに完了を通知し、再生を終えると停止する。
+   * 再生を終えるまでtrajectoryを変更・破棄しないこと。
+   */
+  bool stream(const trajectory::Trajectory &trajectory);
+  /**
+   * @brief 走行モードの完了を待つ
+   * @param progress 完了した走行モードの進捗
+   * @return 時間内に完了したか
+   */
+  bool wait(Progress &progress, TickType_t ticks_to_wait);
+  /**
+   * @brief 現在の走行モードの進捗 (制御周期ごとに更新される)
+   */
+  Progress progress();
+  /**
+   * @brief キューで開始を待っている走行モードの数
+   */
+  uint32_t pending();
 };
 }  // namespace motion
\ No newline at end of file
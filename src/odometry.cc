@@ -2,6 +2,7 @@
 
 // C++
 #include <cmath>
+#include <cstdint>
 #include <limits>
 
 // Project
@@ -109,7 +110,7 @@ class Wheel {
     }
 
     auto angular_velocity = calculate_angular_velocity(current, delta_us);
-    angular_acceleration_ = (angular_velocity - angular_acceleration_) /
+    angular_acceleration_ = (angular_velocity - angular_velocity_) /
                             static_cast<float>(delta_us) * 1000'000.0f;
     velocity_ = angular_velocity * (tire_diameter_ / 2.0f);
     angular_velocity_ = angular_velocity;
@@ -162,6 +163,12 @@ class Odometry::OdometryImpl {
   //! 車体位置 [mm]
   float x_{0.0f}, y_{0.0f};
 
+  //! 走行距離 [mm]
+  float length_{0.0f};
+
+  //! 更新に使ったセンサ値を取得し始めた時刻 [us]
+  int64_t sampled_us_{0};
+
  public:
   explicit OdometryImpl(driver::Driver &dri, config::Config &conf)
       : dri_(dri),
@@ -181,13 +188,16 @@ class Odometry::OdometryImpl {
     angle_ = 0.0f;
     x_ = 0.0f;
     y_ = 0.0f;
+    length_ = 0.0f;
   }
 
   /**
    * @brief 車体情報を更新する
    * @param delta_us 更新周期
+   * @param sampled_us センサ値を取得し始めた時刻 [us]
    */
-  void update(uint32_t delta_us) {
+  void update(uint32_t delta_us, int64_t sampled_us) {
+    sampled_us_ = sampled_us;
     // 左
     left_.update(dri_.encoder_left->raw(), delta_us);
     // 右
@@ -205,12 +215,15 @@ class Odometry::OdometryImpl {
     wheel_vel_.left = left_.velocity();
     wheel_vel_.right = right_.velocity();
     velocity_ = (wheel_vel_.left + wheel_vel_.right) / 2.0f;
+    // 走行距離 [mm]
+    length_ += velocity_ * static_cast<float>(delta_us) / 1000'000.0f;
 
     // 車体角加速度 [rad/s^2]
     auto &gyro = dri_.imu->angular_rate();
     auto angular_velocity =
         -1.0f * gyro.z / 1000.0f * std::numbers::pi_v<float> / 180.0f;
-    angular_acceleration_ = angular_velocity - angular_velocity_;
+    angular_acceleration_ = (angular_velocity - angular_velocity_) /
+                            static_cast<float>(delta_us) * 1000'000.0f;
     // 車体角速度 [rad/s]
     /*
     angular_velocity_ =
@@ -218,7 +231,8 @@ class Odometry::OdometryImpl {
     */
     angular_velocity_ = angular_velocity;
     // 車体角度 [rad]
-    auto angle = angle_ + angular_velocity_ / 1000.0f;
+    auto angle = angle_ + angular_velocity_ * static_cast<float>(delta_us) /
+                              1000'000.0f;
 
     // x, yの位置を推定
     if (std::fabs(angular_velocity_) <= std::numeric_limits<float>::epsilon()) {
@@ -249,6 +263,8 @@ class Odometry::OdometryImpl {
   [[nodiscard]] float angle() const { return angle_; }
   [[nodiscard]] float x() const { return x_; }
   [[nodiscard]] float y() const { return y_; }
+  [[nodiscard]] float length() const { return length_; }
+  [[nodiscard]] int64_t sampled_us() const { return sampled_us_; }
 };
 
 Odometry::Odometry(driver::Driver &dri, config::Config &conf)
@@ -256,7 +272,9 @@ Odometry::Odometry(driver::Driver &dri, config::Config &conf)
 Odometry::~Odometry() = default;
 
 void Odometry::reset() { return impl_->reset(); }
-void Odometry::update(uint32_t delta_us) { return impl_->update(delta_us); }
+void Odometry::update(uint32_t delta_us, int64_t sampled_us) {
+  return impl_->update(delta_us, sampled_us);
+}
 
 float Odometry::acceleration() { return impl_->acceleration(); }
 float Odometry::velocity() { return impl_->velocity(); }
@@ -265,6 +283,8 @@ float Odometry::angular_velocity() { return impl_->angular_velocity(); }
 float Odometry::angle() { return impl_->angle(); }
 float Odometry::x() { return impl_->x(); }
 float Odometry::y() { return impl_->y(); }
+float Odometry::length() { return impl_->length(); }
+int64_t Odometry::sampled_us() { return impl_->sampled_us(); }
 
 const WheelsPair &Odometry::wheels_angular_velocity() {
   return impl_->wheels_angular_velocity();
@@ -1,6 +1,7 @@
 #pragma once
 
 // C++
+#include <cstdint>
 #include <memory>
 
 // Project
@@ -23,7 +24,12 @@ class Odometry {
   ~Odometry();
 
   void reset();
-  void update(uint32_t delta_us);
+  /**
+   * @brief 車体情報を更新する
+   * @param delta_us 更新周期 [us]
+   * @param sampled_us センサ値を取得し始めた時刻 (esp_timer_get_time) [us]
+   */
+  void update(uint32_t delta_us, int64_t sampled_us);
 
   float angular_acceleration();
   float angular_velocity();
@@ -32,6 +38,10 @@ class Odometry {
   float angle();
   float x();
   float y();
+  /// リセットからの走行距離 (後退は減算) [mm]
+  float length();
+  /// 最後の更新に使ったセンサ値を取得し始めた時刻 [us]
+  int64_t sampled_us();
 
   const WheelsPair &wheels_angular_acceleration();
   const WheelsPair &wheels_angular_velocity();
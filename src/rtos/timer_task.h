@@ -0,0 +1,293 @@
+#pragma once
+
+// C++
+#include <algorithm>
+#include <cstdint>
+
+// ESP-IDF
+#include <driver/gptimer.h>
+#include <esp_attr.h>
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace rtos {
+/**
+ * ハードウェアタイマで起動する周期タスク
+ *
+ * gptimerのアラームの割り込みからタスク通知で起こし、
+ * FreeRTOSのティック (CONFIG_FREERTOS_HZ) によらない周期で loop() を呼ぶ。
+ * 通知はドライバが完了待ちに使うインデックス0と分け、NOTIFY_INDEX を使う
+ * (CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2)。
+ * タイマはアラームごとに0から数え直すため、起床時のカウントが
+ * アラームから起床までの遅延となり、その差分が周期のばらつきとなる。
+ *
+ * follow() で別のタスクに連動させると自身のタイマは持たず、
+ * 連動元の loop() が終わるたびに起こされる。
+ * 遅延・周期は連動元のタイマで測るため、連動元のアラームからの遅延となる。
+ * 連動するタスクは連動元より先に停止すること。
+ */
+class TimerTask {
+ public:
+  /// タスク通知のインデックス
+  static constexpr UBaseType_t NOTIFY_INDEX = 1;
+  /// タイマの分解能 [Hz]
+  static constexpr uint32_t TIMER_RESOLUTION_HZ = 10'000'000;
+
+  // 周期のばらつきの統計
+  struct Jitter {
+    /// 起床した回数
+    uint32_t periods;
+    /// loop()が間に合わず取りこぼした周期の数
+    uint32_t missed;
+    /// アラームから起床までの遅延の平均・最大 [us]
+    float latency_mean;
+    float latency_max;
+    /// 起床の間隔の最小・最大 [us]
+    float period_min;
+    float period_max;
+  };
+
+ private:
+  // 実行するタスクの名前
+  const char *name_;
+  // 実行しているタスクのハンドラ
+  TaskHandle_t task_;
+  // タスクの実行周波数 [Hz]
+  uint32_t frequency_;
+  // 周期を刻むタイマ
+  gptimer_handle_t timer_;
+  // 呼び出し元のタスクのハンドラ
+  TaskHandle_t notify_dest_;
+  // 停止リクエスト
+  bool req_stop_;
+  // 前回の時刻
+  int64_t prev_us_;
+  // 前回との差分
+  uint32_t delta_us_;
+
+  // 前回の起床時の遅延 [タイマのカウント]
+  uint64_t prev_latency_;
+  // 遅延の合計 [タイマのカウント]
+  uint64_t latency_sum_;
+  // 周期のばらつきの統計
+  Jitter jitter_;
+
+  // 連動元のタスク (自身のタイマで起きる場合はnullptr)
+  TimerTask *leader_;
+  // 連動するタスク (なければnullptr)
+  TimerTask *follower_;
+  // 連動元から通知する間に、終了したタスクを通知しないための排他
+  portMUX_TYPE lock_;
+  // 連動元が通知している途中か
+  bool notifying_;
+
+  static bool IRAM_ATTR alarm_callback(gptimer_handle_t,
+                                       const gptimer_alarm_event_data_t *,
+                                       void *user_ctx) {
+    auto this_ptr = reinterpret_cast<TimerTask *>(user_ctx);
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveIndexedFromISR(this_ptr->task_, NOTIFY_INDEX,
+                                  &xHigherPriorityTaskWoken);
+    return xHigherPriorityTaskWoken == pdTRUE;
+  }
+
+  // タイマを生成して開始する (割り込みは呼び出したコアに割り当てられる)
+  void start_timer() {
+    gptimer_config_t timer_config = {};
+    timer_config.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+    timer_config.direction = GPTIMER_COUNT_UP;
+    timer_config.resolution_hz = TIMER_RESOLUTION_HZ;
+    ESP_ERROR_CHECK(gptimer_new_timer(&timer_config, &timer_));
+
+    gptimer_event_callbacks_t callback_config = {};
+    callback_config.on_alarm = alarm_callback;
+    ESP_ERROR_CHECK(
+        gptimer_register_event_callbacks(timer_, &callback_config, this));
+
+    gptimer_alarm_config_t alarm = {};
+    alarm.reload_count = 0;
+    alarm.alarm_count = TIMER_RESOLUTION_HZ / frequency_;
+    alarm.flags.auto_reload_on_alarm = true;
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(timer_, &alarm));
+
+    ESP_ERROR_CHECK(gptimer_enable(timer_));
+    ESP_ERROR_CHECK(gptimer_start(timer_));
+  }
+  void stop_timer() {
+    ESP_ERROR_CHECK(gptimer_stop(timer_));
+    ESP_ERROR_CHECK(gptimer_disable(timer_));
+    ESP_ERROR_CHECK(gptimer_del_timer(timer_));
+    timer_ = nullptr;
+  }
+
+  // 連動するタスクを起こす
+  // (クリティカルセクションではハンドラを読むだけにし、通知はその外で行う。
+  //  通知し終えるまで連動するタスクは自身を削除せずに待つ)
+  void notify_follower() {
+    if (follower_ == nullptr) {
+      return;
+    }
+    portENTER_CRITICAL(&follower_->lock_);
+    const auto task = follower_->task_;
+    follower_->notifying_ = task != nullptr;
+    portEXIT_CRITICAL(&follower_->lock_);
+    if (task == nullptr) {
+      return;
+    }
+    xTaskNotifyGiveIndexed(task, NOTIFY_INDEX);
+    portENTER_CRITICAL(&follower_->lock_);
+    follower_->notifying_ = false;
+    portEXIT_CRITICAL(&follower_->lock_);
+  }
+
+  // 起床時の遅延と取りこぼした周期の数から統計を更新する
+  void record(uint32_t notified) {
+    const auto *source = leader_ != nullptr ? leader_ : this;
+    uint64_t latency = 0;
+    if (source->timer_ != nullptr) {
+      gptimer_get_raw_count(source->timer_, &latency);
+    }
+    const auto missed = notified > 0 ? notified - 1 : 0;
+    const auto period_counts = TIMER_RESOLUTION_HZ / source->frequency_;
+    constexpr float US_PER_COUNT = 1000'000.0f / TIMER_RESOLUTION_HZ;
+    const auto latency_us = static_cast<float>(latency) * US_PER_COUNT;
+    if (jitter_.periods > 0) {
+      const auto period =
+          static_cast<float>(static_cast<int64_t>(period_counts) *
+                                 (missed + 1) +
+                             static_cast<int64_t>(latency) -
+                             static_cast<int64_t>(prev_latency_)) *
+          US_PER_COUNT;
+      if (jitter_.periods == 1) {
+        jitter_.period_min = period;
+        jitter_.period_max = period;
+      } else {
+        jitter_.period_min = std::min(jitter_.period_min, period);
+        jitter_.period_max = std::max(jitter_.period_max, period);
+      }
+    }
+    prev_latency_ = latency;
+    latency_sum_ += latency;
+    jitter_.periods++;
+    jitter_.missed += missed;
+    jitter_.latency_max = std::max(jitter_.latency_max, latency_us);
+    jitter_.latency_mean = static_cast<float>(latency_sum_) * US_PER_COUNT /
+                           static_cast<float>(jitter_.periods);
+  }
+
+ protected:
+  // 実行されるタスク
+  static void task(void *pvParameters) {
+    auto this_ptr = reinterpret_cast<TimerTask *>(pvParameters);
+    // 初期化
+    this_ptr->setup();
+    this_ptr->delta_us_ = 0;
+    this_ptr->prev_us_ = esp_timer_get_time();
+    if (this_ptr->leader_ == nullptr) {
+      this_ptr->start_timer();
+    }
+    while (!this_ptr->req_stop_) {
+      // 停止リクエストを確認できるよう、タイマが止まっていても戻る
+      const auto notified = ulTaskNotifyTakeIndexed(NOTIFY_INDEX, pdTRUE,
+                                                    pdMS_TO_TICKS(10));
+      if (notified == 0) {
+        continue;
+      }
+      this_ptr->record(notified);
+      auto curr_us = esp_timer_get_time();
+      this_ptr->delta_us_ = static_cast<uint32_t>(curr_us - this_ptr->prev_us_);
+      this_ptr->prev_us_ = curr_us;
+      this_ptr->loop();
+      this_ptr->notify_follower();
+    }
+    if (this_ptr->timer_ != nullptr) {
+      this_ptr->stop_timer();
+    }
+    // 終了
+    this_ptr->end();
+    // 連動元から通知されないようにし、通知の途中なら終わるまで待つ
+    portENTER_CRITICAL(&this_ptr->lock_);
+    this_ptr->task_ = nullptr;
+    portEXIT_CRITICAL(&this_ptr->lock_);
+    while (true) {
+      portENTER_CRITICAL(&this_ptr->lock_);
+      const auto notifying = this_ptr->notifying_;
+      portEXIT_CRITICAL(&this_ptr->lock_);
+      if (!notifying) {
+        break;
+      }
+      vTaskDelay(1);
+    }
+    // 終了完了を停止要求タスクに通知
+    xTaskNotifyGive(this_ptr->notify_dest_);
+    // タスクを削除
+    vTaskDelete(nullptr);
+  }
+  virtual void setup() = 0;
+  virtual void loop() = 0;
+  virtual void end() = 0;
+
+ public:
+  /**
+   * @param name タスクの名前
+   * @param frequency 実行周波数 [Hz]
+   */
+  explicit TimerTask(const char *name, uint32_t frequency)
+      : name_(name),
+        task_(nullptr),
+        frequency_(frequency),
+        timer_(nullptr),
+        notify_dest_(nullptr),
+        req_stop_(false),
+        prev_us_(),
+        delta_us_(),
+        prev_latency_(),
+        latency_sum_(),
+        jitter_(),
+        leader_(nullptr),
+        follower_(nullptr),
+        lock_(portMUX_INITIALIZER_UNLOCKED),
+        notifying_(false) {}
+  virtual ~TimerTask() = default;
+
+  // タスク開始
+  bool start(uint32_t usStackDepth, UBaseType_t uxPriority,
+             BaseType_t xCoreID) {
+    req_stop_ = false;
+    prev_latency_ = 0;
+    latency_sum_ = 0;
+    jitter_ = {};
+    auto ret = xTaskCreatePinnedToCore(task, name_, usStackDepth, this,
+                                       uxPriority, &task_, xCoreID);
+    return ret == pdTRUE;
+  }
+  // タスク終了
+  bool stop() {
+    notify_dest_ = xTaskGetCurrentTaskHandle();
+    req_stop_ = true;
+    return ulTaskNotifyTake(pdFALSE, portMAX_DELAY) != 0;
+  }
+  /**
+   * @brief 自身のタイマではなく、leader の loop() の後に起きるようにする
+   * @details 開始前に呼ぶこと。連動できるのは1つの連動元に1つまで。
+   */
+  void follow(TimerTask &leader) {
+    leader_ = &leader;
+    leader.follower_ = this;
+  }
+  // 実行周波数の変更 (setup() の中で変更すればその開始から反映)
+  void frequency(uint32_t frequency) { frequency_ = frequency; }
+  // 実行周波数の取得 [Hz]
+  [[nodiscard]] uint32_t frequency() const { return frequency_; }
+  // タスクハンドル取得
+  TaskHandle_t handle() { return task_; }
+  // 計測実行周期の取得
+  [[nodiscard]] uint32_t delta_us() const { return delta_us_; }
+  // 周期のばらつきの統計 (開始から)
+  [[nodiscard]] Jitter jitter() const { return jitter_; }
+  // 停止中か
+  [[nodiscard]] bool is_stopping() const { return req_stop_; }
+};
+}  // namespace rtos
@@ -1,20 +1,68 @@
 #include "run.h"
 
 // C++
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <utility>
 
 // Project
-#include "motion.h"
+#include "data/scurve.h"
+#include "slalom.h"
 
 namespace run {
 class Run::RunImpl {
  private:
+  /// 制御周期 (Motionタスクの周期) [s]
+  static constexpr float PERIOD = 0.001f;
+  /// 超信地旋回の終了を判定する角度の許容誤差 [rad]
+  static constexpr float PIVOT_TOLERANCE = 0.01f;
+  /// 超信地旋回の角度の不足を補う角速度のゲイン [1/s] と上限 [rad/s]
+  static constexpr float PIVOT_GAIN = 10.0f;
+  static constexpr float PIVOT_CREEP = 1.0f;
+  /// 測定した距離・角度で目標値を引く場合に目標が先行してよい量
+  static constexpr float TRACK_LEAD = 2.0f;         // [mm]
+  static constexpr float TRACK_ANGLE_LEAD = 0.02f;  // [rad]
+  /// 斜め直進で柱の横を通過しているとみなす前後の距離 [mm]
+  static constexpr float POST_WINDOW = 10.0f;
+  /// 斜め直進の横方向のずれを打ち消す角速度のゲイン [rad/s/mm] と上限 [rad/s]
+  static constexpr float LATERAL_GAIN = 0.05f;
+  static constexpr float LATERAL_LIMIT = 1.0f;
+
   Target target_;
+  /// 走行モードの開始時か
+  bool first_{true};
+  /// 走行モードの目標値を出し終えたか
+  bool finished_{false};
+  /// 直進・超信地旋回の速度プロファイル
+  data::SCurve curve_;
+  /// 直進が指定の終了速度まで加減速できるか
+  bool feasible_{true};
+  /// 目標値を引く時刻 [s] (測定した距離・角度で引く場合は経過時間より遅れる)
+  float clock_{0.0f};
+  /// プロファイルの終了時刻を超えた周期の、次の走行モードに引き継ぐ時刻 [s]
+  float overshoot_{0.0f};
+  /// 走行モードの開始時の時刻 [s]
+  float carry_{0.0f};
+  /// 走行モードの開始からの観測した距離 [mm]・角度 [rad]
+  float measured_length_{0.0f};
+  float measured_angle_{0.0f};
+  /// 観測値が与えられているか
+  bool measured_{false};
+  /// スラローム旋回の形状
+  slalom::Profile slalom_{};
+  /// 斜めを向いているか (直前までの走行モードから求める)
+  bool diagonal_{false};
+  /// 斜め直進で柱の横を通過しているか
+  bool passing_post_{false};
+  /// 柱の通過時に与えられた横方向のずれ [mm]
+  float lateral_{0.0f};
+  bool corrected_{false};
 
   const Target& free(const Parameter& param) { return target_; }
   const Target& haptic_feedback(const Parameter& param) { return target_; }
   const Target& stop(const Parameter& param) {
+    finished_ = true;
     target_.velocity = 0;
     target_.length = 0;
     target_.angular_velocity = 0;
@@ -23,15 +71,176 @@ class Run::RunImpl {
     return target_;
   }
   const Target& adjust_front(const Parameter& param) { return target_; }
-  const Target& pivot_turn(const Parameter& param) { return target_; }
-  const Target& straight(const Parameter& param) { return target_; }
-  const Target& diagonal(const Parameter& param) { return target_; }
-  const Target& slalom_turn(const Parameter& param) { return target_; }
+  const Target& pivot_turn(const Parameter& param) {
+    const auto sign = param.angle >= 0.0f ? 1.0f : -1.0f;
+    if (first_) {
+      curve_.reset(std::abs(param.angle), 0.0f, 0.0f,
+                   param.max_angular_velocity, param.max_angular_acceleration,
+                   param.max_angular_jerk);
+    }
+    const auto t = advance(
+        param, sign * measured_angle_, TRACK_ANGLE_LEAD, curve_.duration(),
+        [&](float t) { return curve_.at(t).position; });
+    const auto state = curve_.at(t);
+    target_.jerk = 0.0f;
+    target_.acceleration = 0.0f;
+    target_.velocity = 0.0f;
+    target_.length = 0.0f;
+    target_.angular_jerk = sign * state.jerk;
+    target_.angular_acceleration = sign * state.acceleration;
+    target_.angular_velocity = sign * state.velocity;
+    target_.angle = sign * state.position;
+    finished_ = t >= curve_.duration();
+    // プロファイルの終了後もジャイロの角度が足りなければ低速で回り続ける
+    if (measured_ && finished_) {
+      const auto error = param.angle - measured_angle_;
+      if (std::abs(error) > PIVOT_TOLERANCE) {
+        target_.angular_velocity =
+            std::clamp(PIVOT_GAIN * error, -PIVOT_CREEP, PIVOT_CREEP);
+        finished_ = false;
+      }
+    }
+    return target_;
+  }
+  const Target& straight(const Parameter& param) {
+    if (first_) {
+      curve_.reset(param.length, param.start_velocity, param.end_velocity,
+                   param.max_velocity, param.max_acceleration, param.max_jerk);
+      feasible_ = curve_.feasible();
+    }
+    const auto t =
+        advance(param, measured_length_, TRACK_LEAD, curve_.duration(),
+                [&](float t) { return curve_.at(t).position; });
+    const auto state = curve_.at(t);
+    finished_ = t >= curve_.duration();
+    target_.jerk = state.jerk;
+    target_.acceleration = state.acceleration;
+    target_.velocity = state.velocity;
+    target_.length = state.position;
+    target_.angular_jerk = 0.0f;
+    target_.angular_acceleration = 0.0f;
+    target_.angular_velocity = 0.0f;
+    target_.angle = 0.0f;
+    return target_;
+  }
+  const Target& diagonal(const Parameter& param) {
+    // 直進と同じS字加減速で走り、柱の横では横方向のずれを角速度で打ち消す
+    straight(param);
+    const auto phase = std::fmod(target_.length, DIAGONAL_UNIT);
+    passing_post_ =
+        !finished_ && std::abs(phase - DIAGONAL_UNIT / 2.0f) <= POST_WINDOW;
+    if (!passing_post_) {
+      corrected_ = false;
+    } else if (corrected_) {
+      target_.angular_velocity = std::clamp(-LATERAL_GAIN * lateral_,
+                                            -LATERAL_LIMIT, LATERAL_LIMIT);
+    }
+    return target_;
+  }
+  const Target& slalom_turn(const Parameter& param) {
+    if (first_) {
+      slalom_ = slalom::profile(param.mode, diagonal_);
+    }
+    // 旋回速度で等速に走行し、曲線区間では弧長から表を引く
+    const auto v = param.start_velocity > 0.0f
+                       ? param.start_velocity
+                       : slalom::velocity(slalom_, param);
+    const auto before = std::max(slalom_.before, 0.0f);
+    const auto duration = slalom_.travel() / v;
+    const auto t = advance(param, measured_length_, TRACK_LEAD, duration,
+                           [&](float t) { return v * t; });
+    finished_ = t >= duration;
+    const auto s =
+        finished_ ? slalom_.travel() : std::min(v * t, slalom_.travel());
+    target_.jerk = 0.0f;
+    target_.acceleration = 0.0f;
+    target_.velocity = v;
+    target_.length = s;
+    if (s <= before || s >= before + slalom_.length) {
+      target_.angular_jerk = 0.0f;
+      target_.angular_acceleration = 0.0f;
+      target_.angular_velocity = 0.0f;
+      target_.angle = s <= before ? 0.0f : slalom_.angle;
+      return target_;
+    }
+    const auto sample = slalom::sample((s - before) / slalom_.length);
+    const auto sign = slalom_.angle >= 0.0f ? 1.0f : -1.0f;
+    // 曲率は最大で1/radius、弧長での微分は正規化した弧長の分だけ割る
+    const auto k = sign * v / slalom_.radius;
+    const auto rate = v / slalom_.length;
+    target_.angular_velocity = k * sample.curvature;
+    target_.angular_acceleration = k * rate * sample.slope;
+    target_.angular_jerk = k * rate * rate * sample.bend;
+    target_.angle = slalom_.angle * sample.angle;
+    return target_;
+  }
 
- public:
-  const Target& run(const Parameter& param) {
-    target_.parameter = param;
+  /// 走行モードの終了時に斜めを向いているか
+  bool ends_diagonal(Mode mode) const {
+    switch (mode) {
+      case Mode::Diagonal:
+      case Mode::SlalomTurnVLeft90:
+      case Mode::SlalomTurnVRight90:
+        return true;
+      case Mode::SlalomTurnLeft45:
+      case Mode::SlalomTurnRight45:
+      case Mode::SlalomTurnLeft135:
+      case Mode::SlalomTurnRight135:
+        return !diagonal_;
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * @brief 今回の制御周期で目標値を引く時刻を求める
+   * @details
+   * 通常は1周期ずつ進める。
+   * 各周期の目標値は1周期保持されるため、終了時刻を超えた周期の
+   * 保持の終わりから終了時刻までの分を次の走行モードの開始時刻とし、
+   * 走行モードの境界で距離が伸びないようにする。
+   * 測定した距離・角度で引く場合は、目標の位置が測定値に先行量を加えた
+   * 位置となる時刻とし、車体が遅れれば目標値を待たせ、進めば先へ送る。
+   * 時刻は戻さず、プロファイルの終了時刻を超えない。
+   * @param measured 走行モードの開始からの測定した位置
+   * @param lead 目標が測定値より先行する量
+   * @param duration プロファイルの終了時刻
+   * @param position 時刻から目標の位置を求める関数 (単調増加)
+   */
+  template <typename F>
+  float advance(const Parameter& param, float measured, float lead,
+                float duration, F&& position) {
+    const auto previous = first_ ? -1.0f : clock_;
+    overshoot_ = 0.0f;
+    if (first_) {
+      clock_ = carry_;
+    } else if (param.track_distance && measured_) {
+      const auto limit = measured + lead;
+      auto low = clock_;
+      auto high = std::max(duration, clock_);
+      if (position(high) <= limit) {
+        low = high;
+      } else {
+        for (int i = 0; i < 16; i++) {
+          const auto mid = (low + high) / 2.0f;
+          if (position(mid) <= limit) {
+            low = mid;
+          } else {
+            high = mid;
+          }
+        }
+      }
+      clock_ = low;
+    } else {
+      clock_ += PERIOD;
+    }
+    if (!param.track_distance && previous < duration && clock_ >= duration) {
+      overshoot_ = clock_ + PERIOD - duration;
+    }
+    return clock_;
+  }
 
+  const Target& dispatch(const Parameter& param) {
     switch (param.mode) {
       default:
       case Mode::Free:
@@ -69,9 +278,89 @@ class Run::RunImpl {
         return slalom_turn(param);
     }
   }
+
+ public:
+  void reset() {
+    // 直前の周期で終了した走行モードから時刻を引き継ぐ
+    carry_ = finished_ ? overshoot_ : 0.0f;
+    overshoot_ = 0.0f;
+    clock_ = 0.0f;
+    first_ = true;
+    finished_ = false;
+    measured_ = false;
+    passing_post_ = false;
+    corrected_ = false;
+    feasible_ = true;
+  }
+
+  bool finished() const { return finished_; }
+  bool feasible() const { return feasible_; }
+  bool passing_post() const { return passing_post_; }
+
+  void correct(float lateral) {
+    lateral_ = lateral;
+    corrected_ = true;
+  }
+
+  void measure(float length, float angle) {
+    measured_length_ = length;
+    measured_angle_ = angle;
+    measured_ = true;
+  }
+
+  const Target& run(const Parameter& param) {
+    target_.parameter = param;
+    passing_post_ = false;
+    const auto& target = dispatch(param);
+    if (first_) {
+      diagonal_ = ends_diagonal(param.mode);
+    }
+    first_ = false;
+    return target;
+  }
 };
 
+Parameter parameter(const config::Config& conf, Mode mode, Level level) {
+  Parameter param{};
+  param.mode = mode;
+  param.level = level;
+  param.enable_side_wall_adjust = mode == Mode::Straight;
+  param.track_distance = conf.track_distance != 0;
+  if (level == Level::Search) {
+    param.max_velocity = conf.velocity;
+    param.max_acceleration = conf.acceleration;
+    param.max_jerk = conf.jerk;
+    param.max_angular_velocity = conf.angular_velocity;
+    param.max_angular_acceleration = conf.angular_acceleration;
+    param.max_angular_jerk = conf.angular_jerk;
+  } else {
+    const auto i = static_cast<std::size_t>(level) -
+                   static_cast<std::size_t>(Level::Fast0);
+    const auto is_turn = mode != Mode::Straight && mode != Mode::Diagonal;
+    param.max_velocity =
+        is_turn ? conf.fast_turn_velocity[i] : conf.fast_velocity[i];
+    param.max_acceleration = conf.fast_acceleration[i];
+    if (mode == Mode::Diagonal) {
+      param.max_velocity = conf.fast_diagonal_velocity[i];
+      param.max_acceleration = conf.fast_diagonal_acceleration[i];
+    }
+    param.max_jerk = conf.fast_jerk[i];
+    param.max_angular_velocity = conf.fast_angular_velocity[i];
+    param.max_angular_acceleration = conf.fast_angular_acceleration[i];
+    param.max_angular_jerk = conf.fast_angular_jerk[i];
+  }
+  return param;
+}
+
 Run::Run() : impl_(new RunImpl()) {}
 Run::~Run() = default;
+void Run::reset() { impl_->reset(); }
+void Run::measure(float length, float angle) {
+  impl_->measure(length, angle);
+}
+void Run::correct(float lateral) { impl_->correct(lateral); }
+bool Run::passing_post() const { return impl_->passing_post(); }
+bool Run::finished() const { return impl_->finished(); }
+bool Run::feasible() const { return impl_->feasible(); }
 const Target& Run::run(const Parameter& param) { return impl_->run(param); }
 }  // namespace run
\ No newline at end of file
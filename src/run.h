@@ -2,12 +2,17 @@
 
 // C++
 #include <memory>
+#include <numbers>
 
 // Project
 #include "config.h"
-#include "motion.h"
+#include "maze/maze.h"
 
 namespace run {
+/// 斜め直進の距離の単位 (区画の対角線の半分、通過する柱の間隔) [mm]
+inline constexpr float DIAGONAL_UNIT =
+    maze::CELL_SIZE * std::numbers::sqrt2_v<float> / 2.0f;
+
 // パラメータレベル
 enum class Level {
   Search,
@@ -57,6 +62,8 @@ struct Parameter {
   Level level{Level::Search};
   /// 横壁補正有効
   bool enable_side_wall_adjust;
+  /// 経過時間ではなく測定した距離・角度で目標値を引くか
+  bool track_distance;
   /// 最大速度 [mm/s]
   float max_velocity;
   /// 最大加速度 [mm/s^2]
@@ -69,6 +76,14 @@ struct Parameter {
   float max_angular_acceleration;
   /// 最大角躍度 [rad/s^3]
   float max_angular_jerk;
+  /// 走行距離 [mm]
+  float length;
+  /// 旋回角度 [rad]
+  float angle;
+  /// 開始速度 [mm/s]
+  float start_velocity;
+  /// 終了速度 [mm/s]
+  float end_velocity;
 };
 
 // Runクラスで生成する目標値
@@ -93,6 +108,16 @@ struct Target {
   float angle;
 };
 
+/**
+ * @brief 走行モード・レベルに応じた拘束条件を設定から作る
+ * @details
+ * Searchレベルは config::Config::velocity 等を、
+ * Fast0 ~ Fast4 は config::Config::fast_velocity 等を用いる。
+ * スラローム旋回の最大速度は旋回速度とし、斜め直進の最大速度・最大加速度は
+ * config::Config::fast_diagonal_velocity 等とする。
+ */
+Parameter parameter(const config::Config& conf, Mode mode, Level level);
+
 class Run {
  private:
   class RunImpl;
@@ -102,6 +127,57 @@ class Run {
   explicit Run();
   ~Run();
 
+  /**
+   * @brief 新しい走行モードの開始時に呼び、経過時間を0に戻す
+   * @details
+   * 直前のrun()で前の走行モードが終了していれば、終了時刻を超えた分から始め、
+   * 続けて走る走行モードの境界で距離がずれないようにする。
+   */
+  void reset();
+  /**
+   * @brief 走行モードの開始からの観測した距離・角度を与える (run()の前に呼ぶ)
+   * @details
+   * 超信地旋回はプロファイルの終了後に観測した角度が指令に達するまで
+   * 低速で回り続ける。与えない場合はプロファイルのみで終了する。
+   * Parameter::track_distance が有効な場合、直進・スラローム旋回は距離、
+   * 超信地旋回は角度で目標値を引き、車体が遅れた分だけプロファイルを待たせる。
+   * @param length オドメトリから求めた距離 [mm]
+   * @param angle ジャイロから求めた角度 [rad]
+   */
+  void measure(float length, float angle);
+  /**
+   * @brief 制御周期ごとに呼び、走行モードの目標値を生成する
+   */
   const Target& run(const Parameter& param);
+  /**
+   * @brief 横方向のずれを与える (斜め直進の柱の通過時に呼ぶ)
+   * @details
+   * 斜め直進は柱を通過している間、ずれを打ち消す角速度を目標値に加える。
+   * 柱から離れると与えたずれは破棄する。
+   * @param lateral 45度の壁センサから求めた経路からのずれ (左が正) [mm]
+   */
+  void correct(float lateral);
+  /**
+   * @brief 斜め直進で柱の横を通過しているか
+   * @details
+   * 斜め直進は壁の中点から始まり、DIAGONAL_UNIT の半分の奇数倍の位置で
+   * 左右の柱の横を通過する。45度の壁センサで柱を読む区間を表す。
+   */
+  [[nodiscard]] bool passing_post() const;
+  /**
+   * @brief 直前のrun()で走行モードの目標値を出し終えたか
+   * @details
+   * 終了後もrun()を呼ぶと最後の状態(終了速度での走行など)を保つ。
+   * 自由回転・触覚フィードバック・前壁補正は終了しない。
+   */
+  [[nodiscard]] bool finished() const;
+  /**
+   * @brief 開始した直進・斜め直進が指定の終了速度まで加減速できるか
+   * @details
+   * 距離が足りない場合、目標値は加減速の制限を守ったまま終了速度を変える
+   * (data::SCurve)。次の走行モードが計画した速度で始まらなくなるため、
+   * 呼び出し元で走行を中止する。直進以外の走行モードでは常にtrue。
+   */
+  [[nodiscard]] bool feasible() const;
 };
 }  // namespace run
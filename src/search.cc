@@ -0,0 +1,482 @@
+#include "search.h"
+
+// C++
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <numbers>
+#include <string>
+#include <type_traits>
+
+// ESP-IDF
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Project
+#include "config.h"
+#include "driver/driver.h"
+#include "maze/adachi.h"
+#include "maze/journal.h"
+#include "maze/maze.h"
+#include "motion.h"
+#include "odometry.h"
+#include "rtos/queue.h"
+#include "rtos/task.h"
+#include "run.h"
+
+/**
+ * @brief 足立法による連続探索
+ * @details
+ * 区画境界の手前で壁を読み、歩数マップを更新して次の進行方向を決めておき、
+ * 境界に到達した時点で次の走行モードをMotionのキューに追加し、
+ * 前の走行モードに続けて走らせる。
+ * 直進・スラロームは境界から境界までの走行とするため、
+ * 行き止まり以外では区画ごとに停止しない。
+ * ゴール到達後も停止せず、最短経路が確定するまで探索を続けてスタートへ戻る。
+ * 壁情報は区画ごとにストレージへ追記し、リセット後の探索で引き継げる。
+ * 追記とfsyncは数msかかることがあるため、優先度の低いタスクに任せる。
+ * また、迷路・位置・探索の段階をRTCメモリにも保持し、
+ * ブラウンアウトやウォッチドッグによるリセット後は停止した区画から再開できる。
+ */
+namespace search {
+namespace {
+static_assert(std::is_trivially_copyable_v<maze::Maze>);
+
+// リセット後も保持する探索の状態
+struct Retained {
+  static constexpr uint32_t MAGIC = 0x5352434D;  // "MCRS"
+
+  uint32_t magic;
+  //! 迷路 (maze::Mazeはデフォルト構築できないためバイト列で保持する)
+  alignas(maze::Maze) std::array<uint8_t, sizeof(maze::Maze)> maze;
+  uint8_t width;
+  uint8_t height;
+  maze::Position goal;
+  //! 次に進入する区画・進行方向
+  maze::Position pos;
+  maze::Direction dir;
+  maze::Phase phase;
+  uint32_t checksum;
+
+  [[nodiscard]] uint32_t crc() const {
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(this),
+                            offsetof(Retained, checksum));
+  }
+};
+
+//! 電源投入時以外のリセットでは初期化されない
+RTC_NOINIT_ATTR Retained retained;
+
+/**
+ * @brief 壁情報のレコードをキューから受け取り、ファイルに追記する
+ * @details 停止する際はキューに残ったレコードを書き出してから終了する
+ */
+class JournalWriter final : public rtos::Task {
+ private:
+  //! キューの長さ (書き出しが滞っても探索を止めない区画数)
+  static constexpr UBaseType_t QUEUE_LENGTH = 64;
+  //! キューを確認する周期 [ms]
+  static constexpr uint32_t PERIOD_MS = 10;
+
+  maze::Journal &journal_;
+  rtos::Queue<maze::Journal::Record> queue_;
+
+  void drain() {
+    maze::Journal::Record record{};
+    while (queue_.receive(&record, 0)) {
+      journal_.append(record);
+    }
+  }
+
+  void setup() override {}
+  void loop() override { drain(); }
+  void end() override { drain(); }
+
+ public:
+  explicit JournalWriter(maze::Journal &journal)
+      : rtos::Task(__func__, pdMS_TO_TICKS(PERIOD_MS)),
+        journal_(journal),
+        queue_(QUEUE_LENGTH) {}
+  ~JournalWriter() override = default;
+
+  /**
+   * @brief 区画の四方の壁をキューに積む (待たない)
+   * @return キューに空きがあったか
+   */
+  bool post(const maze::Maze &maze, maze::Position pos) {
+    const auto record = maze::Journal::record(maze, pos);
+    return queue_.send(&record, 0);
+  }
+};
+}  // namespace
+
+class Search::SearchImpl {
+ private:
+  static constexpr auto TAG = "search::Search";
+
+  //! 壁を読む位置 (区画境界の手前) [mm]
+  static constexpr float SENSING_DISTANCE = 10.0f;
+  //! 停止とみなす速度 [mm/s]
+  static constexpr float STOP_VELOCITY = 10.0f;
+  //! 停止位置・旋回角度の許容誤差
+  static constexpr float LENGTH_TOLERANCE = 2.0f;  // [mm]
+  static constexpr float ANGLE_TOLERANCE = 0.05f;  // [rad]
+  //! 記録のタスクの優先度 (探索のタスクより低くする)
+  static constexpr UBaseType_t WRITER_PRIORITY = 1;
+
+  // 壁センサの添字 (config::Config::photo_wall_thresholdの並び)
+  static constexpr std::size_t LEFT90_POS = 0;
+  static constexpr std::size_t LEFT45_POS = 1;
+  static constexpr std::size_t RIGHT45_POS = 2;
+  static constexpr std::size_t RIGHT90_POS = 3;
+
+  // 進行方向から見た壁
+  struct Walls {
+    bool front;
+    bool left;
+    bool right;
+  };
+
+  driver::Driver &dri_;
+  config::Config &conf_;
+  odometry::Odometry &odom_;
+  motion::Motion &mot_;
+
+  //! 探索の判断 (設定を読み込んだ後に作り直す)
+  std::unique_ptr<maze::Adachi> adachi_;
+  //! 壁情報の記録
+  maze::Journal journal_;
+  //! 壁情報の記録を書き出すタスク
+  JournalWriter writer_{journal_};
+  //! 走行を開始した区画と向き (オドメトリの原点)
+  maze::Position origin_{maze::Adachi::START};
+  maze::Direction heading_{maze::Direction::North};
+
+  /**
+   * @brief 迷路座標系での車体位置 [mm]
+   * @details
+   * オドメトリは走行を開始した区画の中央でリセットされる。
+   * オドメトリのx軸が開始時の向き、y軸がその左に対応する。
+   */
+  [[nodiscard]] float maze_x() const {
+    const auto center =
+        (static_cast<float>(origin_.x) + 0.5f) * maze::CELL_SIZE;
+    switch (heading_) {
+      case maze::Direction::North:
+        return center - odom_.y();
+      case maze::Direction::East:
+        return center + odom_.x();
+      case maze::Direction::South:
+        return center + odom_.y();
+      default:
+      case maze::Direction::West:
+        return center - odom_.x();
+    }
+  }
+  [[nodiscard]] float maze_y() const {
+    const auto center =
+        (static_cast<float>(origin_.y) + 0.5f) * maze::CELL_SIZE;
+    switch (heading_) {
+      case maze::Direction::North:
+        return center + odom_.x();
+      case maze::Direction::East:
+        return center + odom_.y();
+      case maze::Direction::South:
+        return center - odom_.x();
+      default:
+      case maze::Direction::West:
+        return center - odom_.y();
+    }
+  }
+
+  /**
+   * @brief 次に進入する区画の境界までの残り距離 [mm]
+   */
+  [[nodiscard]] float remaining() const {
+    const auto pos = adachi_->position();
+    switch (adachi_->direction()) {
+      case maze::Direction::North:
+        return static_cast<float>(pos.y) * maze::CELL_SIZE - maze_y();
+      case maze::Direction::East:
+        return static_cast<float>(pos.x) * maze::CELL_SIZE - maze_x();
+      case maze::Direction::South:
+        return maze_y() - static_cast<float>(pos.y + 1) * maze::CELL_SIZE;
+      default:
+      case maze::Direction::West:
+        return maze_x() - static_cast<float>(pos.x + 1) * maze::CELL_SIZE;
+    }
+  }
+
+  /**
+   * @brief 壁センサから壁の有無を判定する
+   */
+  Walls sense() {
+    auto value = [](const driver::hardware::Photo::Result &result) {
+      return result.flash - result.ambient;
+    };
+    const auto &threshold = conf_.photo_wall_threshold;
+    const auto front = value(dri_.photo->left90()) +
+                       value(dri_.photo->right90());
+    return {
+        .front = front > threshold[LEFT90_POS] + threshold[RIGHT90_POS],
+        .left = value(dri_.photo->left45()) > threshold[LEFT45_POS],
+        .right = value(dri_.photo->right45()) > threshold[RIGHT45_POS],
+    };
+  }
+
+  [[nodiscard]] maze::Position goal() const {
+    return {static_cast<int8_t>(conf_.maze_goal[0]),
+            static_cast<int8_t>(conf_.maze_goal[1])};
+  }
+
+  /**
+   * @brief 現在の探索の状態をRTCメモリに保持する
+   */
+  void retain() {
+    retained.magic = Retained::MAGIC;
+    std::memcpy(retained.maze.data(), &adachi_->maze(), sizeof(maze::Maze));
+    retained.width = static_cast<uint8_t>(adachi_->maze().width());
+    retained.height = static_cast<uint8_t>(adachi_->maze().height());
+    retained.goal = adachi_->goal();
+    retained.pos = adachi_->position();
+    retained.dir = adachi_->direction();
+    retained.phase = adachi_->phase();
+    retained.checksum = retained.crc();
+  }
+  static void discard() { retained.magic = 0; }
+
+  /**
+   * @brief 区画の壁情報の記録を記録のタスクに渡す
+   */
+  void record(maze::Position pos) {
+    if (!writer_.post(adachi_->maze(), pos)) {
+      ESP_LOGW(TAG, "Journal queue is full at (%d, %d)", pos.x, pos.y);
+    }
+  }
+  /**
+   * @brief 最後の区画を記録し、書き出しを終えてファイルを閉じる
+   */
+  void close_journal(maze::Position pos) {
+    record(pos);
+    writer_.stop();
+    journal_.close();
+  }
+
+  /**
+   * @brief 探索レベルの走行パラメータ
+   */
+  [[nodiscard]] run::Parameter parameter(run::Mode mode, float length,
+                                         float angle, float start_velocity,
+                                         float end_velocity) const {
+    auto param = run::parameter(conf_, mode, run::Level::Search);
+    param.length = length;
+    param.angle = angle;
+    param.start_velocity = start_velocity;
+    param.end_velocity = end_velocity;
+    return param;
+  }
+  /// 走行モードをMotionのキューに追加する (前の走行モードの後に続けて走る)
+  void send(const run::Parameter &param) { mot_.push(param); }
+
+  /**
+   * @brief 条件を満たすまで待つ
+   */
+  template <typename F>
+  static void wait_until(F &&cond) {
+    while (!cond()) {
+      vTaskDelay(pdMS_TO_TICKS(1));
+    }
+  }
+
+  /**
+   * @brief 渡した走行モードを全て終え、停止するまで待つ
+   */
+  void wait_stopped() {
+    wait_until([&] {
+      return mot_.pending() == 0 && mot_.progress().completed &&
+             std::abs(odom_.velocity()) < STOP_VELOCITY;
+    });
+  }
+
+  /**
+   * @brief 区画中央で停止し、その場で180度旋回して境界まで戻る
+   */
+  void turn_back() {
+    const auto velocity = conf_.velocity;
+    const auto half = maze::CELL_SIZE / 2.0f;
+    send(parameter(run::Mode::Straight, half, 0.0f, velocity, 0.0f));
+    wait_until([&] {
+      return remaining() <= -(half - LENGTH_TOLERANCE) &&
+             std::abs(odom_.velocity()) < STOP_VELOCITY;
+    });
+    const auto angle = odom_.angle();
+    send(parameter(run::Mode::PivotTurn, 0.0f, std::numbers::pi_v<float>,
+                   0.0f, 0.0f));
+    wait_until([&] {
+      return std::abs(odom_.angle() - angle) >=
+             std::numbers::pi_v<float> - ANGLE_TOLERANCE;
+    });
+    send(parameter(run::Mode::Straight, half, 0.0f, 0.0f, velocity));
+  }
+
+ public:
+  explicit SearchImpl(driver::Driver &dri, config::Config &conf,
+                      odometry::Odometry &odom, motion::Motion &mot)
+      : dri_(dri),
+        conf_(conf),
+        odom_(odom),
+        mot_(mot),
+        adachi_(std::make_unique<maze::Adachi>(conf.maze_size, goal())),
+        journal_(std::string(dri.fs->base_path()) + "/maze.bin") {}
+  ~SearchImpl() = default;
+
+  /**
+   * @brief スタート区画からゴール区画まで探索し、スタート区画へ戻る
+   * @details
+   * Sensor・Motionタスクが開始されている必要がある。
+   * 区画の中央で停止してから戻るため、戻った後に直ちにタスクを停止してよい。
+   * Resume::Warmでは停止した区画の中央に進行方向を向けて
+   * 置かれているものとする。
+   * @return スタート区画に戻ったか
+   */
+  bool run(Resume resume) {
+    const auto velocity = conf_.velocity;
+    const auto half = maze::CELL_SIZE / 2.0f;
+
+    adachi_ = std::make_unique<maze::Adachi>(conf_.maze_size, goal());
+    auto stored = std::make_unique<maze::Maze>(conf_.maze_size);
+    if (resume == Resume::Warm && warm()) {
+      std::memcpy(stored.get(), retained.maze.data(), sizeof(maze::Maze));
+      adachi_->restore(*stored, retained.phase, retained.pos, retained.dir);
+      ESP_LOGI(TAG, "Resuming from (%d, %d) with retained state",
+               retained.pos.x, retained.pos.y);
+    } else if (resume != Resume::None &&
+               journal_.load(*stored, adachi_->goal())) {
+      adachi_->resume(*stored);
+      ESP_LOGI(TAG, "Resuming with %d stored cells", journal_.records());
+    }
+    stored.reset();
+    if (!journal_.create(adachi_->maze(), adachi_->goal())) {
+      ESP_LOGW(TAG, "Search continues without journal");
+    }
+    writer_.start(4096, WRITER_PRIORITY, 1);
+    heading_ = adachi_->direction();
+    origin_ = maze::neighbor(adachi_->position(), maze::rotate(heading_, 2));
+    retain();
+    odom_.reset();
+
+    // スタート区画中央から北の区画境界へ (前回の走行の残りは破棄する)
+    auto first = parameter(run::Mode::Straight, half, 0.0f, 0.0f, velocity);
+    mot_.set(first);
+
+    while (true) {
+      // 境界の手前で壁を読み、次の方向を決める
+      wait_until([&] { return remaining() <= SENSING_DISTANCE; });
+      const auto walls = sense();
+      const auto phase = adachi_->phase();
+      adachi_->update(walls.front, walls.left, walls.right);
+      const auto turn = adachi_->finished() ? std::nullopt : adachi_->next();
+      // 境界に到達する前に次の走行を渡し、境界で止まらずに引き継がせる
+      if (adachi_->finished() || !turn.has_value()) {
+        // 区画中央で停止
+        send(parameter(run::Mode::Straight, half, 0.0f, velocity, 0.0f));
+      } else {
+        switch (*turn) {
+          case maze::Turn::Straight:
+            send(parameter(run::Mode::Straight, maze::CELL_SIZE, 0.0f,
+                           velocity, velocity));
+            break;
+          case maze::Turn::Left:
+            send(parameter(run::Mode::SlalomTurnLeft90, 0.0f,
+                           std::numbers::pi_v<float> / 2.0f, velocity,
+                           velocity));
+            break;
+          case maze::Turn::Right:
+            send(parameter(run::Mode::SlalomTurnRight90, 0.0f,
+                           -std::numbers::pi_v<float> / 2.0f, velocity,
+                           velocity));
+            break;
+          case maze::Turn::Back:
+            turn_back();
+            break;
+        }
+      }
+      wait_until([&] { return remaining() <= 0.0f; });
+
+      const auto pos = adachi_->position();
+      if (phase == maze::Phase::Goal && adachi_->phase() != phase) {
+        ESP_LOGI(TAG, "Reached goal (%d, %d)", pos.x, pos.y);
+      }
+      if (phase != maze::Phase::Return &&
+          adachi_->phase() == maze::Phase::Return) {
+        const auto &candidates = adachi_->candidates();
+        ESP_LOGI(TAG, "Returning from (%d, %d): shortest %d, proven %d", pos.x,
+                 pos.y, candidates.known_length(), candidates.proven());
+      }
+      if (adachi_->finished()) {
+        // スタート区画中央で停止するまで待つ
+        wait_stopped();
+        close_journal(pos);
+        discard();
+        return true;
+      }
+      if (!turn.has_value()) {
+        wait_stopped();
+        close_journal(pos);
+        discard();
+        ESP_LOGW(TAG, "No route to target from (%d, %d)", pos.x, pos.y);
+        return false;
+      }
+
+      // 境界を越えてから記録を渡す (書き出しは待たない)
+      record(pos);
+      adachi_->advance(*turn);
+      retain();
+    }
+  }
+
+  bool load() {
+    adachi_ = std::make_unique<maze::Adachi>(conf_.maze_size, goal());
+    auto stored = std::make_unique<maze::Maze>(conf_.maze_size);
+    if (!journal_.load(*stored, adachi_->goal())) {
+      return false;
+    }
+    adachi_->resume(*stored);
+    return true;
+  }
+
+  /**
+   * @brief RTCメモリに再開できる探索の状態が残っているか
+   * @details
+   * パニック・ソフトウェアリセットはRTCメモリが壊れているか、
+   * 意図して止めた可能性があるため再開しない
+   */
+  [[nodiscard]] bool warm() const {
+    const auto reason = esp_reset_reason();
+    return reason != ESP_RST_POWERON && reason != ESP_RST_PANIC &&
+           reason != ESP_RST_SW &&
+           retained.magic == Retained::MAGIC &&
+           retained.checksum == retained.crc() &&
+           retained.goal == goal() && retained.width == conf_.maze_size[0] &&
+           retained.height == conf_.maze_size[1];
+  }
+
+  const maze::Maze &maze() { return adachi_->maze(); }
+};
+
+Search::Search(driver::Driver &dri, config::Config &conf,
+               odometry::Odometry &odom, motion::Motion &mot)
+    : impl_(new SearchImpl(dri, conf, odom, mot)) {}
+Search::~Search() = default;
+
+bool Search::run(Resume resume) { return impl_->run(resume); }
+bool Search::load() { return impl_->load(); }
+bool Search::warm() { return impl_->warm(); }
+const maze::Maze &Search::maze() { return impl_->maze(); }
+}  // namespace search
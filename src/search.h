@@ -0,0 +1,40 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <memory>
+
+// Project
+#include "config.h"
+#include "driver/driver.h"
+#include "maze/maze.h"
+#include "motion.h"
+#include "odometry.h"
+
+namespace search {
+// 探索の再開方法
+enum class Resume : uint8_t {
+  None,     // 記録を引き継がずにスタート区画から探索する
+  Journal,  // ストレージに記録した壁情報を引き継ぎ、スタート区画から探索する
+  Warm,     // RTCメモリに保持した状態を引き継ぎ、停止した区画から探索する
+};
+
+class Search {
+ private:
+  class SearchImpl;
+  std::unique_ptr<SearchImpl> impl_;
+
+ public:
+  explicit Search(driver::Driver &dri, config::Config &conf,
+                  odometry::Odometry &odom, motion::Motion &mot);
+  ~Search();
+
+  bool run(Resume resume = Resume::None);
+  /**
+   * @brief ストレージに記録した壁情報を maze() に読み込む (走行はしない)
+   */
+  bool load();
+  bool warm();
+  const maze::Maze &maze();
+};
+}  // namespace search
@@ -1,47 +1,86 @@
 #include "sensor.h"
 
+// C++
+#include <algorithm>
+
+// ESP-IDF
+#include <esp_timer.h>
+
 // Project
+#include "config.h"
 #include "driver/driver.h"
 #include "odometry.h"
-#include "rtos/task.h"
+#include "rtos/timer_task.h"
 
 namespace sensor {
-class Sensor::SensorImpl final : public rtos::Task {
+/**
+ * 制御周期ごとに電池電圧・IMU・エンコーダを取得してオドメトリを更新する。
+ * 壁センサは4つを順に発光・受光するため1回の取得に約800usかかり、
+ * 制御周期を1msより短くすると待ちきれない。
+ * そのため取得を開始したら待たずに戻り、毎周期完了を確認して
+ * 完了していれば次の取得を開始する (壁センサの更新は約1ms周期となる)。
+ * オドメトリを更新したら、連動する motion::Motion の制御をすぐに起こす。
+ */
+class Sensor::SensorImpl final : public rtos::TimerTask {
  private:
   static constexpr uint32_t WARM_UP_COUNTS = 10;
 
   driver::Driver &dri_;
+  config::Config &conf_;
   odometry::Odometry &odom_;
+  // 壁センサの取得中か
+  bool sampling_{false};
 
-  void update() const {
+  void update() {
     dri_.battery->update();
-    dri_.photo->update();
+    if (!sampling_) {
+      dri_.photo->update();
+      sampling_ = true;
+    }
     dri_.imu->update();
     dri_.encoder_left->update();
     dri_.encoder_right->update();
-    dri_.photo->wait();
+    if (dri_.photo->wait(0)) {
+      sampling_ = false;
+    }
   }
 
   void setup() override {
+    // 1kHzの倍数 (1kHz ~ 4kHz) に丸める
+    frequency(static_cast<uint32_t>(
+        std::clamp(conf_.control_frequency / 1000, 1, 4) * 1000));
     for (uint32_t i = 0; i < WARM_UP_COUNTS; i++) {
       update();
+      if (sampling_) {
+        dri_.photo->wait();
+        sampling_ = false;
+      }
     }
     odom_.reset();
   }
   void loop() override {
+    const auto sampled_us = esp_timer_get_time();
     update();
-    odom_.update(delta_us());
+    odom_.update(delta_us(), sampled_us);
+  }
+  void end() override {
+    // 取得中の壁センサのタイマを止める
+    if (sampling_) {
+      dri_.photo->wait();
+      sampling_ = false;
+    }
   }
-  void end() override {}
 
  public:
-  explicit SensorImpl(driver::Driver &dri, odometry::Odometry &odom)
-      : rtos::Task(__func__, pdMS_TO_TICKS(1)), dri_(dri), odom_(odom) {}
+  explicit SensorImpl(driver::Driver &dri, config::Config &conf,
+                      odometry::Odometry &odom)
+      : rtos::TimerTask(__func__, 1000), dri_(dri), conf_(conf), odom_(odom) {}
   ~SensorImpl() override = default;
 };
 
-Sensor::Sensor(driver::Driver &dri, odometry::Odometry &odom)
-    : impl_(new SensorImpl(dri, odom)) {}
+Sensor::Sensor(driver::Driver &dri, config::Config &conf,
+               odometry::Odometry &odom)
+    : impl_(new SensorImpl(dri, conf, odom)) {}
 Sensor::~Sensor() = default;
 
 bool Sensor::start(uint32_t usStackDepth, UBaseType_t uxPriority,
@@ -50,4 +89,6 @@ bool Sensor::start(uint32_t usStackDepth, UBaseType_t uxPriority,
 }
 bool Sensor::stop() { return impl_->stop(); }
 uint32_t Sensor::delta_us() { return impl_->delta_us(); }
-}  // namespace sensor
\ No newline at end of file
+rtos::TimerTask::Jitter Sensor::jitter() { return impl_->jitter(); }
+rtos::TimerTask &Sensor::task() { return *impl_; }
+}  // namespace sensor
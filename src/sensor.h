@@ -8,8 +8,10 @@
 #include <freertos/task.h>
 
 // Project
+#include "config.h"
 #include "driver/driver.h"
 #include "odometry.h"
+#include "rtos/timer_task.h"
 
 namespace sensor {
 class Sensor {
@@ -18,12 +20,18 @@ class Sensor {
   std::unique_ptr<SensorImpl> impl_;
 
  public:
-  explicit Sensor(driver::Driver &dri, odometry::Odometry &odom);
+  explicit Sensor(driver::Driver &dri, config::Config &conf,
+                  odometry::Odometry &odom);
   ~Sensor();
 
   bool start(uint32_t usStackDepth, UBaseType_t uxPriority, BaseType_t xCoreID);
   bool stop();
 
   uint32_t delta_us();
+  rtos::TimerTask::Jitter jitter();
+  /**
+   * @brief 制御のタスクを連動させるための取得のタスク
+   */
+  rtos::TimerTask &task();
 };
 }  // namespace sensor
\ No newline at end of file
@@ -0,0 +1,259 @@
+#pragma once
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <utility>
+
+// Project
+#include "maze/maze.h"
+#include "run.h"
+
+namespace slalom {
+/**
+ * スラローム旋回の形状
+ *
+ * 曲率を弧長に対して (1 - cos(2πu)) / 2 (uは曲線区間で正規化した弧長) とし、
+ * 曲率・角速度・角加速度が曲線区間の両端で0から連続的に変化する形状とする。
+ * 旋回速度が一定であれば軌跡は速度によらないため、
+ * 形状の表は旋回の種類ごとに弧長で引く形でコンパイル時に求めて
+ * フラッシュに置き、走行レベルは旋回速度として1周期ごとの倍率にのみ現れる。
+ * 半径は曲線区間の前後の直進が指定の下限以上となる最大の値とし、
+ * 旋回の始点・終点は区画境界(斜めは壁の中点)とする。
+ */
+
+// 旋回の種類
+enum class Shape : uint8_t { Turn45, Turn90, Turn135, Turn180, TurnV90 };
+static constexpr std::size_t SHAPES = 5;
+
+/// 曲率の表の分割数
+static constexpr std::size_t SAMPLES = 64;
+
+// 旋回の形状 (左旋回、45度・135度は直交から斜めへ向かう向き)
+struct Profile {
+  /// 旋回角度 [rad] (左旋回が正)
+  float angle;
+  /// 最大曲率での旋回半径 [mm]
+  float radius;
+  /// 曲線区間の弧長 [mm]
+  float length;
+  /// 曲線区間の前の直進距離 [mm] (負なら前の直進を短縮する)
+  float before;
+  /// 曲線区間の後の直進距離 [mm] (負なら後の直進を短縮する)
+  float after;
+
+  /// 始点から終点までの走行距離 [mm]
+  [[nodiscard]] constexpr float distance() const {
+    return before + length + after;
+  }
+  /// 旋回として走行する距離 [mm] (前後の直進の負の部分を除く)
+  [[nodiscard]] constexpr float travel() const {
+    return std::max(before, 0.0f) + length + std::max(after, 0.0f);
+  }
+};
+
+// 正規化した弧長での値
+struct Sample {
+  /// 旋回角度に対する割合
+  float angle;
+  /// 最大曲率に対する割合
+  float curvature;
+  /// curvatureの正規化した弧長での1階微分・2階微分
+  float slope;
+  float bend;
+};
+
+namespace detail {
+constexpr double PI = std::numbers::pi;
+constexpr double CELL = maze::CELL_SIZE;
+
+// コンパイル時に評価する三角関数 ([-π, π]に畳み込んでTaylor展開)
+constexpr double sin(double x) {
+  while (x > PI) x -= 2.0 * PI;
+  while (x < -PI) x += 2.0 * PI;
+  double term = x;
+  double sum = x;
+  for (int n = 1; n < 16; n++) {
+    term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+constexpr double cos(double x) { return sin(x + PI / 2.0); }
+
+// 正規化した弧長uでの旋回角度の割合
+constexpr double angle(double u) { return u - sin(2.0 * PI * u) / (2.0 * PI); }
+
+constexpr std::array<Sample, SAMPLES + 1> table() {
+  std::array<Sample, SAMPLES + 1> ret{};
+  for (std::size_t i = 0; i <= SAMPLES; i++) {
+    const auto u = static_cast<double>(i) / static_cast<double>(SAMPLES);
+    const auto w = 2.0 * PI * u;
+    ret[i] = {static_cast<float>(angle(u)),
+              static_cast<float>((1.0 - cos(w)) / 2.0),
+              static_cast<float>(PI * sin(w)),
+              static_cast<float>(2.0 * PI * PI * cos(w))};
+  }
+  return ret;
+}
+
+// 旋回の条件 (左旋回の始点から見た終点の座標と前後の直進の下限)
+struct Spec {
+  double angle;
+  double forward;
+  double left;
+  double min_before;
+  double min_after;
+};
+
+constexpr Profile profile(const Spec &spec) {
+  // 半径1での曲線区間の変位
+  constexpr int STEPS = 256;
+  const auto theta = spec.angle;
+  double x = 0.0;
+  double y = 0.0;
+  for (int i = 0; i < STEPS; i++) {
+    const auto u = (static_cast<double>(i) + 0.5) / STEPS;
+    x += cos(theta * angle(u));
+    y += sin(theta * angle(u));
+  }
+  x *= 2.0 * theta / STEPS;
+  y *= 2.0 * theta / STEPS;
+
+  const auto s = sin(theta);
+  const auto c = cos(theta);
+  double radius;
+  double before;
+  double after;
+  if (s < 1e-6 && s > -1e-6) {
+    // 180度: 横方向の変位で半径が決まり、前後の直進は平行
+    radius = spec.left / y;
+    const auto excess = spec.forward - radius * x;
+    before = std::max(spec.min_before, excess + spec.min_after);
+    after = before - excess;
+  } else {
+    // 前後の直進が下限以上となる最大の半径を二分探索する
+    auto solve = [&](double r, double &b, double &a) {
+      a = (spec.left - r * y) / s;
+      b = spec.forward - r * x - a * c;
+      return b >= spec.min_before && a >= spec.min_after;
+    };
+    double low = 1.0;
+    double high = CELL * 4.0;
+    for (int i = 0; i < 40; i++) {
+      const auto mid = (low + high) / 2.0;
+      if (solve(mid, before, after)) {
+        low = mid;
+      } else {
+        high = mid;
+      }
+    }
+    radius = low;
+    solve(radius, before, after);
+  }
+  return {static_cast<float>(theta), static_cast<float>(radius),
+          static_cast<float>(2.0 * theta * radius),
+          static_cast<float>(before), static_cast<float>(after)};
+}
+
+constexpr double HALF = CELL / 2.0;
+constexpr double DIAGONAL = CELL / std::numbers::sqrt2;
+}  // namespace detail
+
+/// 正規化した弧長での値の表
+inline constexpr auto TABLE = detail::table();
+
+/**
+ * 旋回の種類ごとの形状
+ * 45度は直交側の始点を通る直線上に終点があるため、直交側の直進を短縮する。
+ */
+inline constexpr std::array<Profile, SHAPES> PROFILES = {
+    detail::profile({detail::PI / 4.0, detail::HALF, detail::HALF,
+                     -detail::CELL * 3.0 / 8.0, 0.0}),
+    detail::profile({detail::PI / 2.0, detail::HALF, detail::HALF, 0.0, 0.0}),
+    detail::profile(
+        {detail::PI * 3.0 / 4.0, 0.0, detail::CELL, 0.0, 0.0}),
+    detail::profile({detail::PI, 0.0, detail::CELL, 0.0, 0.0}),
+    detail::profile(
+        {detail::PI / 2.0, detail::DIAGONAL, detail::DIAGONAL, 0.0, 0.0}),
+};
+
+/**
+ * @brief 走行モードに対応する旋回の種類
+ */
+constexpr Shape shape(run::Mode mode) {
+  switch (mode) {
+    case run::Mode::SlalomTurnLeft45:
+    case run::Mode::SlalomTurnRight45:
+      return Shape::Turn45;
+    case run::Mode::SlalomTurnLeft135:
+    case run::Mode::SlalomTurnRight135:
+      return Shape::Turn135;
+    case run::Mode::SlalomTurnLeft180:
+    case run::Mode::SlalomTurnRight180:
+      return Shape::Turn180;
+    case run::Mode::SlalomTurnVLeft90:
+    case run::Mode::SlalomTurnVRight90:
+      return Shape::TurnV90;
+    default:
+      return Shape::Turn90;
+  }
+}
+
+/**
+ * @brief 走行モードの旋回の形状
+ * @param diagonal 斜めから旋回を始めるか (45度・135度は前後の直進を入れ替える)
+ */
+constexpr Profile profile(run::Mode mode, bool diagonal) {
+  const auto s = shape(mode);
+  auto ret = PROFILES[static_cast<std::size_t>(s)];
+  if (diagonal && (s == Shape::Turn45 || s == Shape::Turn135)) {
+    std::swap(ret.before, ret.after);
+  }
+  switch (mode) {
+    case run::Mode::SlalomTurnRight45:
+    case run::Mode::SlalomTurnRight90:
+    case run::Mode::SlalomTurnRight135:
+    case run::Mode::SlalomTurnRight180:
+    case run::Mode::SlalomTurnVRight90:
+      ret.angle = -ret.angle;
+      break;
+    default:
+      break;
+  }
+  return ret;
+}
+
+/**
+ * @brief 走行レベルの角速度・角加速度の制限を守る旋回速度 [mm/s]
+ * @details
+ * 旋回速度vでの角速度の最大は v / radius、角加速度の最大は
+ * π v^2 / (radius * length) (曲率の弧長での微分の最大がπ) となるため、
+ * 旋回速度の上限 (param.max_velocity) を両者が制限以下となる速度に抑える。
+ */
+inline float velocity(const Profile &profile, const run::Parameter &param) {
+  const auto by_velocity = profile.radius * param.max_angular_velocity;
+  const auto by_acceleration =
+      std::sqrt(param.max_angular_acceleration * profile.radius *
+                profile.length / std::numbers::pi_v<float>);
+  return std::min({param.max_velocity, by_velocity, by_acceleration});
+}
+
+/**
+ * @brief 正規化した弧長uでの値を表から線形補間で求める
+ */
+inline Sample sample(float u) {
+  const auto x = std::clamp(u, 0.0f, 1.0f) * static_cast<float>(SAMPLES);
+  const auto i = std::min(static_cast<std::size_t>(x), SAMPLES - 1);
+  const auto f = x - static_cast<float>(i);
+  const auto &a = TABLE[i];
+  const auto &b = TABLE[i + 1];
+  return {a.angle + (b.angle - a.angle) * f,
+          a.curvature + (b.curvature - a.curvature) * f,
+          a.slope + (b.slope - a.slope) * f, a.bend + (b.bend - a.bend) * f};
+}
+}  // namespace slalom
@@ -0,0 +1,116 @@
+#pragma once
+
+// C++
+#include <cmath>
+#include <numbers>
+
+// Project
+#include "config.h"
+#include "run.h"
+
+namespace motion {
+/**
+ * 軌道追従制御
+ *
+ * 参考:
+ * Y. Kanayama, Y. Kimura, F. Miyazaki, T. Noguchi,
+ * "A stable tracking control method for an autonomous mobile robot", 1990
+ *
+ * 目標値の速度・角速度を積分した参照姿勢とオドメトリの姿勢を比べ、
+ * 車体座標系での前後・横・角度の偏差 (e_x, e_y, e_θ) から
+ * motion::Model に与える速度・角速度の目標値を補正する。
+ *   v = v_r cos(e_θ) + kx·e_x
+ *   ω = ω_r + v_r (ky·e_y + kθ sin(e_θ))
+ * 速度・角速度の制御は旋回中の遅れや車輪径の誤差で生じた横ずれ・角度のずれを
+ * 戻せないため、その外側で姿勢のループを閉じる。
+ * 目標速度が小さい間 (停止・超信地旋回) は横ずれを戻せないため補正せず、
+ * 参照姿勢を測定した姿勢に合わせる。
+ */
+class Tracker {
+ public:
+  /// 制御周期 [s]
+  static constexpr float PERIOD = 0.001f;
+  /// 補正する目標速度の下限 [mm/s]
+  static constexpr float MIN_VELOCITY = 10.0f;
+
+ private:
+  /// 設定
+  config::Config &conf_;
+  /// 参照姿勢 [mm], [rad]
+  float x_{0.0f};
+  float y_{0.0f};
+  float angle_{0.0f};
+  /// 車体座標系での偏差 (前・左が正) [mm], [rad]
+  float error_x_{0.0f};
+  float error_y_{0.0f};
+  float error_angle_{0.0f};
+  /// 補正した目標値
+  run::Target target_{};
+
+ public:
+  explicit Tracker(config::Config &conf) : conf_(conf) {}
+  ~Tracker() = default;
+
+  /**
+   * @brief 参照姿勢を測定した姿勢に合わせる
+   */
+  void reset(float x, float y, float angle) {
+    x_ = x;
+    y_ = y;
+    angle_ = angle;
+    error_x_ = 0.0f;
+    error_y_ = 0.0f;
+    error_angle_ = 0.0f;
+  }
+
+  /**
+   * @brief 測定した姿勢から目標値を補正し、参照姿勢を1周期分進める
+   * @param target 目標値
+   * @param x, y, angle オドメトリの姿勢 [mm], [rad]
+   * @return 速度・角速度を補正した目標値
+   */
+  const run::Target &track(const run::Target &target, float x, float y,
+                           float angle) {
+    target_ = target;
+    if (std::abs(target.velocity) < MIN_VELOCITY) {
+      reset(x, y, angle);
+    } else {
+      // 参照姿勢との偏差を車体座標系に変換する
+      const auto dx = x_ - x;
+      const auto dy = y_ - y;
+      const auto c = std::cos(angle);
+      const auto s = std::sin(angle);
+      error_x_ = c * dx + s * dy;
+      error_y_ = -s * dx + c * dy;
+      error_angle_ = std::remainder(angle_ - angle,
+                                    2.0f * std::numbers::pi_v<float>);
+
+      const auto &gain = conf_.track_pose_gain;
+      target_.velocity =
+          target.velocity * std::cos(error_angle_) + gain[0] * error_x_;
+      target_.angular_velocity =
+          target.angular_velocity +
+          target.velocity *
+              (gain[1] * error_y_ + gain[2] * std::sin(error_angle_));
+    }
+
+    // 参照姿勢を中点の角度で1周期分進める
+    const auto distance = target.velocity * PERIOD;
+    const auto turn = target.angular_velocity * PERIOD;
+    const auto mid = angle_ + turn / 2.0f;
+    x_ += distance * std::cos(mid);
+    y_ += distance * std::sin(mid);
+    angle_ += turn;
+    return target_;
+  }
+
+  /// 参照姿勢 [mm], [rad]
+  [[nodiscard]] float x() const { return x_; }
+  [[nodiscard]] float y() const { return y_; }
+  [[nodiscard]] float angle() const { return angle_; }
+  /// 車体座標系での偏差 (前・左が正) [mm], [rad]
+  [[nodiscard]] float error_x() const { return error_x_; }
+  [[nodiscard]] float error_y() const { return error_y_; }
+  [[nodiscard]] float error_angle() const { return error_angle_; }
+};
+}  // namespace motion
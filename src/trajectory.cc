@@ -0,0 +1,96 @@
+#include "trajectory.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// Project
+#include "data/scurve.h"
+
+namespace trajectory {
+namespace {
+// 単位lsbで量子化する (範囲外ならfalse)
+bool quantize(float value, float lsb, int16_t &out) {
+  const auto q = std::lround(value / lsb);
+  if (q < std::numeric_limits<int16_t>::min() ||
+      q > std::numeric_limits<int16_t>::max()) {
+    return false;
+  }
+  out = static_cast<int16_t>(q);
+  return true;
+}
+}  // namespace
+
+bool Trajectory::bake(const std::vector<run::Parameter> &route) {
+  clear();
+  if (!route.empty()) {
+    level_ = route.front().level;
+  }
+  ends_.reserve(route.size());
+  // 走行時間で確保し、再確保によるメモリの断片化を避ける
+  float duration = 0.0f;
+  data::SCurve curve;
+  for (const auto &param : route) {
+    if (param.mode == run::Mode::Straight ||
+        param.mode == run::Mode::Diagonal) {
+      curve.reset(param.length, param.start_velocity, param.end_velocity,
+                  param.max_velocity, param.max_acceleration, param.max_jerk);
+      // 計画した終了速度まで加減速しきれない経路は焼き込まない
+      if (!curve.feasible()) {
+        return false;
+      }
+      duration += curve.duration();
+    } else if (param.start_velocity > 0.0f) {
+      duration += param.length / param.start_velocity;
+    }
+  }
+  // 走行モードごとに端数の1周期を加える
+  setpoints_.reserve(std::min(
+      static_cast<std::size_t>(duration / PERIOD) + route.size() * 2,
+      MAX_TICKS));
+
+  run::Run run;
+  float velocity = 0.0f;
+  for (std::size_t i = 0; i < route.size(); i++) {
+    auto param = route[i];
+    if (i > 0 && (param.mode == run::Mode::Straight ||
+                  param.mode == run::Mode::Diagonal)) {
+      param.start_velocity = velocity;
+    }
+    run.reset();
+    do {
+      if (setpoints_.size() >= MAX_TICKS) {
+        clear();
+        return false;
+      }
+      const auto &target = run.run(param);
+      if (!run.feasible()) {
+        clear();
+        return false;
+      }
+      Setpoint p;
+      if (!quantize(target.velocity, VELOCITY_LSB, p.velocity) ||
+          !quantize(target.acceleration, ACCELERATION_LSB, p.acceleration) ||
+          !quantize(target.angular_velocity, ANGULAR_VELOCITY_LSB,
+                    p.angular_velocity) ||
+          !quantize(target.angular_acceleration, ANGULAR_ACCELERATION_LSB,
+                    p.angular_acceleration)) {
+        clear();
+        return false;
+      }
+      setpoints_.push_back(p);
+      velocity = target.velocity;
+    } while (!run.finished());
+    ends_.push_back(static_cast<uint32_t>(setpoints_.size()));
+  }
+  return true;
+}
+
+void Trajectory::clear() {
+  // capacityも解放する
+  std::vector<Setpoint>().swap(setpoints_);
+  std::vector<uint32_t>().swap(ends_);
+}
+}  // namespace trajectory
@@ -0,0 +1,110 @@
+#pragma once
+
+// C++
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Project
+#include "run.h"
+
+namespace trajectory {
+// 1制御周期の目標値 (固定小数点)
+struct Setpoint {
+  /// 目標速度 [Trajectory::VELOCITY_LSB]
+  int16_t velocity;
+  /// 目標加速度 [Trajectory::ACCELERATION_LSB]
+  int16_t acceleration;
+  /// 目標角速度 [Trajectory::ANGULAR_VELOCITY_LSB]
+  int16_t angular_velocity;
+  /// 目標角加速度 [Trajectory::ANGULAR_ACCELERATION_LSB]
+  int16_t angular_acceleration;
+};
+
+/**
+ * @brief 走行モードの列の目標値を制御周期ごとに焼き込んだ軌道
+ * @details
+ * スタート区画で待機している間に run::Run で全ての目標値を生成し、
+ * 固定小数点に量子化してRAMに置く。
+ * 走行中の motion::Motion は添字で読み出して戻すだけになるため、
+ * 1周期の計算量は走行モードによらず一定となる。
+ * 1周期は8byte、1秒の走行で8kBとなる。
+ * 直進・斜め直進の開始速度は motion::Motion::push と同様に
+ * 前の走行モードの終了時の目標速度とする。
+ * 観測値で終了を判定する超信地旋回は、観測値を与えずに焼き込む。
+ * 同様に run::Parameter::track_distance によらず経過時間で焼き込む。
+ */
+class Trajectory {
+ public:
+  /// 制御周期 [s]
+  static constexpr float PERIOD = 0.001f;
+  /// 量子化の単位 (int16_tで ±4096 mm/s, ±32768 mm/s^2, ±65 rad/s,
+  /// ±8192 rad/s^2)
+  static constexpr float VELOCITY_LSB = 0.125f;            // [mm/s]
+  static constexpr float ACCELERATION_LSB = 1.0f;          // [mm/s^2]
+  static constexpr float ANGULAR_VELOCITY_LSB = 0.002f;    // [rad/s]
+  static constexpr float ANGULAR_ACCELERATION_LSB = 0.25f;  // [rad/s^2]
+  /// 焼き込める最大の制御周期の数 (60秒)
+  static constexpr std::size_t MAX_TICKS = 60'000;
+
+ private:
+  //! 制御周期ごとの目標値
+  std::vector<Setpoint> setpoints_;
+  //! 走行モードごとの終了の制御周期の次の添字
+  std::vector<uint32_t> ends_;
+  //! 走行レベル (先頭の走行モードの値)
+  run::Level level_{run::Level::Search};
+
+ public:
+  explicit Trajectory() = default;
+  ~Trajectory() = default;
+
+  /**
+   * @brief 走行モードの列の目標値を焼き込む
+   * @return 全ての走行モードが終了し、量子化の範囲に収まったか
+   *         (直進が計画した終了速度まで加減速しきれない場合もfalse)
+   */
+  bool bake(const std::vector<run::Parameter> &route);
+
+  /**
+   * @brief 焼き込んだ目標値を破棄してメモリを解放する
+   */
+  void clear();
+
+  /**
+   * @brief i番目の制御周期の目標値を戻す
+   * @details 躍度は0とし、距離・角度は変更しない (読み出す側で積分する)。
+   */
+  void at(std::size_t i, run::Target &target) const {
+    const auto &p = setpoints_[i];
+    target.jerk = 0.0f;
+    target.acceleration = static_cast<float>(p.acceleration) * ACCELERATION_LSB;
+    target.velocity = static_cast<float>(p.velocity) * VELOCITY_LSB;
+    target.angular_jerk = 0.0f;
+    target.angular_acceleration =
+        static_cast<float>(p.angular_acceleration) * ANGULAR_ACCELERATION_LSB;
+    target.angular_velocity =
+        static_cast<float>(p.angular_velocity) * ANGULAR_VELOCITY_LSB;
+  }
+
+  /// 制御周期の数
+  [[nodiscard]] std::size_t size() const { return setpoints_.size(); }
+  /// 走行モードの数
+  [[nodiscard]] std::size_t segments() const { return ends_.size(); }
+  /// 走行モードの終了の制御周期の次の添字
+  [[nodiscard]] std::size_t end(std::size_t segment) const {
+    return ends_[segment];
+  }
+  /// 走行レベル
+  [[nodiscard]] run::Level level() const { return level_; }
+  /// 走行時間 [s]
+  [[nodiscard]] float duration() const {
+    return static_cast<float>(setpoints_.size()) * PERIOD;
+  }
+  /// 目標値のメモリ使用量 [byte]
+  [[nodiscard]] std::size_t bytes() const {
+    return setpoints_.capacity() * sizeof(Setpoint) +
+           ends_.capacity() * sizeof(uint32_t);
+  }
+};
+}  // namespace trajectory
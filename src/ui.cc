@@ -1,3 +1,154 @@
 #include "ui.h"
 
-namespace ui {}
\ No newline at end of file
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <numbers>
+
+// ESP-IDF
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace ui {
+class Ui::UiImpl {
+ private:
+  /// 1回の操作とする車輪の回転角 [rad]
+  static constexpr float STEP_ANGLE = std::numbers::pi_v<float> / 2.0f;
+  /// 車輪の回転を確認する周期 [ms]
+  static constexpr uint32_t POLL_MS = 1;
+  /// 選んでいる項目の色・確認を待つ間の色
+  static constexpr uint32_t SELECT_COLOR = 0x00'00'FF;
+  static constexpr uint32_t CONFIRM_COLOR = 0xFF'80'00;
+
+  // 操作
+  enum class Input : uint8_t { None, Next, Previous, Ok, Cancel };
+
+  driver::Driver &dri_;
+  odometry::Odometry &odom_;
+  sensor::Sensor &sens_;
+  // 前回の操作からの左右の車輪の回転角 [rad]
+  float left_{0.0f};
+  float right_{0.0f};
+  // 前回車輪の回転を確認した時刻 [us]
+  int64_t prev_us_{0};
+
+  void begin() {
+    left_ = 0.0f;
+    right_ = 0.0f;
+    sens_.start(8192, 20, 0);
+    prev_us_ = esp_timer_get_time();
+  }
+  void end() {
+    sens_.stop();
+    dri_.indicator->clear();
+    dri_.indicator->update();
+  }
+  void beep(driver::hardware::Buzzer::Mode mode) {
+    dri_.buzzer->set(mode, false);
+    dri_.buzzer->update();
+  }
+  // 全てのインジケータを同じ色にする
+  void fill(uint32_t rgb) {
+    for (uint16_t i = 0; i < dri_.indicator->counts(); i++) {
+      dri_.indicator->set(i, rgb);
+    }
+    dri_.indicator->update();
+  }
+  // 項目を2進数で表示する
+  void show(int item) {
+    for (uint16_t i = 0; i < dri_.indicator->counts(); i++) {
+      dri_.indicator->set(i, (item >> i) & 1 ? SELECT_COLOR : 0);
+    }
+    dri_.indicator->update();
+  }
+
+  // 1周期待ち、車輪が1操作分回っていればその操作を返す
+  Input poll() {
+    // ティックが1msより長くても少なくとも1ティック待つ
+    vTaskDelay(std::max<TickType_t>(pdMS_TO_TICKS(POLL_MS), 1));
+    const auto now_us = esp_timer_get_time();
+    const auto dt = static_cast<float>(now_us - prev_us_) / 1000'000.0f;
+    prev_us_ = now_us;
+    const auto &velocity = odom_.wheels_angular_velocity();
+    left_ += velocity.left * dt;
+    right_ += velocity.right * dt;
+    auto input = Input::None;
+    if (left_ >= STEP_ANGLE) {
+      input = Input::Ok;
+    } else if (left_ <= -STEP_ANGLE) {
+      input = Input::Cancel;
+    } else if (right_ >= STEP_ANGLE) {
+      input = Input::Next;
+    } else if (right_ <= -STEP_ANGLE) {
+      input = Input::Previous;
+    }
+    if (input != Input::None) {
+      left_ = 0.0f;
+      right_ = 0.0f;
+    }
+    return input;
+  }
+
+ public:
+  explicit UiImpl(driver::Driver &dri, odometry::Odometry &odom,
+                  sensor::Sensor &sens)
+      : dri_(dri), odom_(odom), sens_(sens) {}
+  ~UiImpl() = default;
+
+  int select(int count) {
+    using Mode = driver::hardware::Buzzer::Mode;
+    begin();
+    int item = 0;
+    show(item);
+    while (true) {
+      switch (poll()) {
+        case Input::Next:
+          item = (item + 1) % count;
+          break;
+        case Input::Previous:
+          item = (item + count - 1) % count;
+          break;
+        case Input::Ok:
+          end();
+          beep(Mode::Ok);
+          return item;
+        case Input::Cancel:
+          end();
+          beep(Mode::Cancel);
+          return -1;
+        case Input::None:
+          continue;
+      }
+      show(item);
+      beep(Mode::Select);
+    }
+  }
+
+  bool confirm(uint32_t timeout_ms) {
+    using Mode = driver::hardware::Buzzer::Mode;
+    begin();
+    fill(CONFIRM_COLOR);
+    const auto deadline_us =
+        esp_timer_get_time() + static_cast<int64_t>(timeout_ms) * 1000;
+    while (esp_timer_get_time() < deadline_us) {
+      const auto input = poll();
+      if (input == Input::Ok || input == Input::Cancel) {
+        end();
+        beep(input == Input::Ok ? Mode::Ok : Mode::Cancel);
+        return input == Input::Ok;
+      }
+    }
+    end();
+    beep(Mode::Cancel);
+    return false;
+  }
+};
+
+Ui::Ui(driver::Driver &dri, odometry::Odometry &odom, sensor::Sensor &sens)
+    : impl_(new UiImpl(dri, odom, sens)) {}
+Ui::~Ui() = default;
+
+int Ui::select(int count) { return impl_->select(count); }
+bool Ui::confirm(uint32_t timeout_ms) { return impl_->confirm(timeout_ms); }
+}  // namespace ui
@@ -1,19 +1,45 @@
 #pragma once
 
 // C++
+#include <cstdint>
 #include <memory>
 
 // Project
 #include "driver/driver.h"
+#include "odometry.h"
+#include "sensor.h"
 
-namespace {
+namespace ui {
+/**
+ * 車輪を手で回して操作する
+ *
+ * 右の車輪を前に回すと次の項目、後ろに回すと前の項目を選び、
+ * 左の車輪を前に回すと確定、後ろに回すと取り消す。
+ * 選んでいる項目はインジケータに2進数で表示する。
+ * 車輪の回転はオドメトリの車輪の角速度を積分して測るため、
+ * 操作を待つ間はセンサ取得のタスクを動かす (走行中は使わないこと)。
+ */
 class Ui {
  private:
   class UiImpl;
   std::unique_ptr<UiImpl> impl_;
 
  public:
-  explicit Ui(driver::Driver &dri);
+  explicit Ui(driver::Driver &dri, odometry::Odometry &odom,
+              sensor::Sensor &sens);
   ~Ui();
+
+  /**
+   * @brief 項目を選ぶ
+   * @param count 項目の数
+   * @return 確定した項目 (取り消したら-1)
+   */
+  int select(int count);
+  /**
+   * @brief 確定か取り消しを待つ
+   * @param timeout_ms 待つ時間 [ms] (過ぎたら取り消しとする)
+   * @return 確定したか
+   */
+  bool confirm(uint32_t timeout_ms);
 };
-}  // namespace
\ No newline at end of file
+}  // namespace ui